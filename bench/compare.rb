@@ -0,0 +1,54 @@
+# Compares two results of the same benchmark, bench/convert_bench.rb or
+# vendor/ruby-math-3d/bench (rbench_double / rbench_single), and exits with 1
+# when a measure got worse by more than the threshold (10% by default) :
+#
+#   ruby bench/compare.rb BASELINE.json CURRENT.json [THRESHOLD_PERCENT]
+require 'json'
+
+# measures compared for each benchmark, results are matched on their key
+BENCHMARKS = {
+    'convert' => { :key => %w[fixture stage], :measures => %w[wall_median allocations peak_rss_kb] },
+    'rmath' => { :key => %w[function level], :measures => %w[ns_median] }
+}
+
+baseline_file, current_file, threshold = ARGV
+abort "usage: ruby #{$0} BASELINE.json CURRENT.json [THRESHOLD_PERCENT]" unless baseline_file && current_file
+threshold = (threshold || 10).to_f
+
+baseline = JSON.parse(File.read(baseline_file))
+current = JSON.parse(File.read(current_file))
+
+unless baseline['benchmark'] == current['benchmark'] && BENCHMARKS.key?(current['benchmark'])
+    abort "#{baseline_file} and #{current_file} are not results of the same benchmark"
+end
+
+spec = BENCHMARKS[current['benchmark']]
+key = lambda { |result| result.values_at(*spec[:key]).join(' / ') }
+baseline_results = Hash[baseline['results'].map { |result| [key.call(result), result] }]
+
+regressions = 0
+
+current['results'].each do |result|
+    name = key.call(result)
+    before = baseline_results[name]
+
+    if result['error']
+        puts "#{name} : #{result['error']}"
+        regressions += 1
+        next
+    end
+    next if before.nil? || before['error']
+
+    spec[:measures].each do |measure|
+        old, new = before[measure], result[measure]
+        next if old.nil? || new.nil? || old <= 0
+
+        change = 100.0 * (new - old) / old
+        worse = change > threshold
+        regressions += 1 if worse
+
+        puts "%-40s %-12s %14.6g -> %14.6g %+8.1f%%%s" % [name, measure, old, new, change, worse ? '  REGRESSION' : '']
+    end
+end
+
+exit(regressions > 0 ? 1 : 0)
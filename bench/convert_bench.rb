@@ -0,0 +1,241 @@
+# Times the conversion of the spec fixtures stage by stage and prints the
+# results as JSON (see bench/compare.rb to compare two of them) :
+#
+#   ruby bench/convert_bench.rb [--runs N] [--output FILE]
+#
+# Each stage is run --runs times after a GC.start, and reports its wall
+# time, allocated objects, GC time and count, and the peak RSS of the
+# process during the stage (VmHWM, reset before each run where Linux
+# allows it, otherwise the peak since the start of the process).
+$LOAD_PATH.unshift(File.expand_path('../../lib', __FILE__)) unless $LOAD_PATH.include?(File.expand_path('../../lib', __FILE__))
+require File.expand_path('../../lib/lol_model_format', __FILE__)
+require 'json'
+require 'optparse'
+require 'stringio'
+
+include LolModelFormat
+include LolModelFormat::Md2
+include LolModelFormat::Dae
+
+class ConvertBench
+
+    FIXTURE_DIR = File.expand_path('../../spec/fixture', __FILE__)
+
+    attr_reader :results
+
+    def initialize(runs)
+        @runs = runs
+        @results = []
+        @failed = false
+
+        GC::Profiler.enable unless GC.stat.key? :time
+    end
+
+    def failed?
+        @failed
+    end
+
+    # runs the block @runs times as +stage+ of +fixture+, returns its last value
+    def stage(fixture, stage)
+        runs = []
+        value = nil
+
+        @runs.times do
+            GC.start
+            rss_reset = reset_peak_rss
+
+            gc_before = GC.stat
+            started = clock
+
+            value = yield
+
+            wall = clock - started
+            gc_after = GC.stat
+
+            runs << {
+                :wall => wall,
+                :allocations => gc_after[:total_allocated_objects] - gc_before[:total_allocated_objects],
+                :gc_time_ms => gc_time(gc_after) - gc_time(gc_before),
+                :gc_count => gc_after[:count] - gc_before[:count],
+                :peak_rss_kb => peak_rss_kb,
+                :peak_rss_reset => rss_reset
+            }
+        end
+
+        @results << summarize(fixture, stage, runs)
+        value
+    rescue StandardError, LoadError => e
+        @failed = true
+        @results << { :fixture => fixture, :stage => stage, :error => "#{e.class}: #{e.message}" }
+        nil
+    end
+
+    def annie
+        dir = File.join(FIXTURE_DIR, 'Annie')
+        anm_files = Dir[File.join(dir, 'Annie_*.anm')].sort
+
+        skl, skn, anms = stage('Annie', 'parse') do
+            skl = File.open(File.join(dir, 'Annie.skl'), 'rb') { |io| SklFile.read(io) }
+            skn = File.open(File.join(dir, 'Annie.skn'), 'rb') { |io| SknFile.read(io) }
+            anms = {}
+            anm_files.each do |file|
+                anms[File.basename(file, '.anm').sub('Annie_', '')] = File.open(file, 'rb') { |io| AnmFile.read(io) }
+            end
+            [skl, skn, anms]
+        end
+
+        if LolModelFormat.native?
+            stage('Annie', 'parse_mapped') do
+                maps = [Native::SklMap.new(File.join(dir, 'Annie.skl')), Native::SknMap.new(File.join(dir, 'Annie.skn'))]
+                maps.concat anm_files.map { |file| Native::AnmMap.new(file) }
+                maps.each(&:close)
+            end
+        end
+
+        return if skl.nil?
+
+        model = LolModel.new(skl, skn, anms)
+
+        # the skeleton, the poses of each animation and their palettes
+        palettes = stage('Annie', 'skeleton') do
+            skeleton = model.gen_native_skeleton_from_skl
+            anms.map { |name, anm| [name, skeleton.evaluate(model.get_anm_poses(anm))] }
+        end
+
+        packed = model.pack_vertices(skn.vertices)
+        buffers = stage('Annie', 'skinning') do
+            (palettes || []).map do |name, animation|
+                [name, animation.map { |palette| RVec3.skinVertices(packed.positions, packed.normals, packed.bone_indices, packed.weights, palette) }]
+            end
+        end
+
+        md2_model = Md2Model.new(model)
+        frames = stage('Annie', 'md2_frames') do
+            frames = [md2_model.get_md2_frame_from_buffers('static001', packed.positions, packed.normals)]
+            (buffers || []).each do |name, animation|
+                animation.each_with_index do |(positions, normals), i|
+                    frames << md2_model.get_md2_frame_from_buffers(md2_model.md2_frame_name(name, i), positions, normals)
+                end
+            end
+            frames
+        end
+
+        if frames
+            stage('Annie', 'md2_write') do
+                md2_model.write_md2_from_frames(StringIO.new, frames)
+            end
+        end
+
+        stage('Annie', 'dae') do
+            DaeModel.new(model).to_dae('Annie')
+        end
+    end
+
+    def ogro
+        md2 = stage('ogro', 'parse') do
+            File.open(File.join(FIXTURE_DIR, 'ogro', 'ogro.md2'), 'rb') { |io| Md2File.read(io) }
+        end
+
+        return if md2.nil?
+
+        # the frames of the file decoded, then quantized again
+        md2_model = Md2Model.new(nil)
+        decoded = md2.frames.map do |frame|
+            positions = []
+            normals = []
+            frame.verts.each do |vertex|
+                positions.push vertex.v[0] * frame.scale.x + frame.translate.x,
+                               vertex.v[1] * frame.scale.y + frame.translate.y,
+                               vertex.v[2] * frame.scale.z + frame.translate.z
+                normals.concat Md2File::Anorms[vertex.normal_index]
+            end
+            [frame.name.to_s.delete("\0"), positions.pack('f*'), normals.pack('f*')]
+        end
+
+        stage('ogro', 'md2_frames') do
+            decoded.map { |name, positions, normals| md2_model.get_md2_frame_from_buffers(name, positions, normals) }
+        end
+
+        stage('ogro', 'md2_write') do
+            md2.write(StringIO.new)
+        end
+    end
+
+    def report
+        {
+            :benchmark => 'convert',
+            :ruby => RUBY_DESCRIPTION,
+            :native => LolModelFormat.native?,
+            :rmath_precision => defined?(RMath::PRECISION) ? RMath::PRECISION : nil,
+            :rmath_simd_level => RMath.respond_to?(:getSIMDLevel) ? RMath.getSIMDLevel : nil,
+            :runs => @runs,
+            :time => Time.now.utc.strftime('%Y-%m-%dT%H:%M:%SZ'),
+            :results => @results
+        }
+    end
+
+    private
+
+    def summarize(fixture, stage, runs)
+        median = runs.sort_by { |run| run[:wall] }[runs.size / 2]
+
+        {
+            :fixture => fixture,
+            :stage => stage,
+            :wall_min => runs.map { |run| run[:wall] }.min,
+            :wall_median => median[:wall],
+            :allocations => median[:allocations],
+            :gc_time_ms => median[:gc_time_ms],
+            :gc_count => median[:gc_count],
+            :peak_rss_kb => runs.map { |run| run[:peak_rss_kb] }.compact.max,
+            :peak_rss_reset => runs.all? { |run| run[:peak_rss_reset] },
+            :runs => runs
+        }
+    end
+
+    def clock
+        Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    end
+
+    # GC.stat(:time) from Ruby 3.1 on, GC::Profiler before
+    def gc_time(stat)
+        stat.key?(:time) ? stat[:time] : GC::Profiler.total_time * 1000.0
+    end
+
+    # resets VmHWM to the current RSS (Linux 4.0 and later)
+    def reset_peak_rss
+        File.open('/proc/self/clear_refs', 'w') { |io| io.write '5' }
+        true
+    rescue SystemCallError, IOError
+        false
+    end
+
+    def peak_rss_kb
+        status = File.read('/proc/self/status')
+        status[/^VmHWM:\s*(\d+)/, 1].to_i
+    rescue SystemCallError, IOError
+        nil
+    end
+end
+
+runs = 3
+output = nil
+
+OptionParser.new do |opts|
+    opts.banner = "usage: ruby #{$0} [--runs N] [--output FILE]"
+    opts.on('--runs N', Integer) { |n| runs = [n, 1].max }
+    opts.on('--output FILE') { |file| output = file }
+end.parse!
+
+bench = ConvertBench.new(runs)
+bench.annie
+bench.ogro
+
+json = JSON.pretty_generate(bench.report)
+if output
+    File.open(output, 'w') { |io| io.puts json }
+else
+    puts json
+end
+
+exit 1 if bench.failed?
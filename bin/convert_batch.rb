@@ -0,0 +1,20 @@
+# Converts every model of a directory laid out as spec/fixture and prints
+# the throughput of each stage :
+#
+#   ruby bin/convert_batch.rb INPUT_DIR OUTPUT_DIR [WORKERS]
+$LOAD_PATH.unshift(File.expand_path('../../lib', __FILE__)) unless $LOAD_PATH.include?(File.expand_path('../../lib', __FILE__))
+require File.expand_path('../../lib/lol_model_format', __FILE__)
+
+include LolModelFormat
+
+input_dir, output_dir, workers = ARGV
+abort "usage: ruby #{$0} INPUT_DIR OUTPUT_DIR [WORKERS]" unless input_dir && output_dir
+
+options = {}
+options[:workers] = workers.to_i if workers
+
+converter = BatchConverter.new(output_dir, options)
+files = converter.convert(BatchConverter.assets_in(input_dir))
+
+puts files
+puts converter.report
@@ -0,0 +1,340 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "LolDae.h"
+
+/********************************************************************************
+ *
+ * Number formatting
+ *
+ ********************************************************************************/
+
+static const double LolDaePow10[LOL_DAE_MAX_DIGITS + 1] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+/* DBL_DIG : Float#to_s switches to the exponent form from 1e16 on */
+#define LOL_DAE_FIXED_DECPT_MAX 15
+
+static size_t
+LolDaeFormatUInt( char* out, unsigned long long value )
+{
+    char tmp[24];
+    size_t n = 0, i;
+
+    do
+    {
+        tmp[n++] = (char)( '0' + value % 10 );
+        value /= 10;
+    } while ( value != 0 );
+
+    for ( i = 0; i < n; ++i )
+        out[i] = tmp[n - 1 - i];
+
+    return n;
+}
+
+/* Float#to_s of the positive value 0.d1d2...dn x 10^decpt */
+static size_t
+LolDaeFormatDigits( char* out, const char* digits, int count, int decpt )
+{
+    char* p = out;
+    int i;
+
+    if ( 0 < decpt && decpt <= LOL_DAE_FIXED_DECPT_MAX )
+    {
+        for ( i = 0; i < decpt; ++i )
+            *p++ = i < count ? digits[i] : '0';
+        *p++ = '.';
+        if ( count > decpt )
+        {
+            memcpy( p, digits + decpt, (size_t)(count - decpt) );
+            p += count - decpt;
+        }
+        else
+            *p++ = '0';
+    }
+    else if ( -4 < decpt && decpt <= 0 )
+    {
+        *p++ = '0';
+        *p++ = '.';
+        for ( i = decpt; i < 0; ++i )
+            *p++ = '0';
+        memcpy( p, digits, (size_t)count );
+        p += count;
+    }
+    else
+    {
+        *p++ = digits[0];
+        *p++ = '.';
+        if ( count > 1 )
+        {
+            memcpy( p, digits + 1, (size_t)(count - 1) );
+            p += count - 1;
+        }
+        else
+            *p++ = '0';
+        p += sprintf( p, "e%+03d", decpt - 1 );
+    }
+
+    return (size_t)(p - out);
+}
+
+static size_t
+LolDaeFormatSpecial( char* out, double value )
+{
+    const char* s;
+
+    if ( isnan( value ) )
+        s = "NaN";
+    else if ( isinf( value ) )
+        s = value > 0 ? "Infinity" : "-Infinity";
+    else
+        s = signbit( value ) ? "-0.0" : "0.0";
+
+    memcpy( out, s, strlen( s ) );
+    return strlen( s );
+}
+
+/* Float#to_s : the shortest digits reading back as +value+ */
+size_t
+LolDaeFormatFloat( char* out, double value )
+{
+    char buf[40];
+    char digits[20];
+    char* p = out;
+    int precision, count, exponent;
+    const char* e;
+
+    if ( isnan( value ) || isinf( value ) || value == 0.0 )
+        return LolDaeFormatSpecial( out, value );
+
+    if ( value < 0.0 )
+    {
+        *p++ = '-';
+        value = -value;
+    }
+
+    for ( precision = 1; precision < 17; ++precision )
+    {
+        snprintf( buf, sizeof(buf), "%.*e", precision - 1, value );
+        if ( strtod( buf, NULL ) == value )
+            break;
+    }
+    snprintf( buf, sizeof(buf), "%.*e", precision - 1, value );
+
+    /* d.ddde+XX */
+    count = 0;
+    for ( e = buf; *e != 'e'; ++e )
+    {
+        if ( *e != '.' )
+            digits[count++] = *e;
+    }
+    exponent = atoi( e + 1 );
+    while ( count > 1 && digits[count - 1] == '0' )
+        --count;
+
+    return (size_t)(p - out) + LolDaeFormatDigits( p, digits, count, exponent + 1 );
+}
+
+/* round_half_up of Ruby's float.c */
+static double
+LolDaeRoundHalfUp( double x, double s )
+{
+    double f, xs = x * s;
+
+    f = round( xs );
+    if ( x > 0 )
+    {
+        if ( (double)((f + 0.5) / s) <= x )
+            f += 1;
+        x = f;
+    }
+    else
+    {
+        if ( (double)((f - 0.5) / s) >= x )
+            f -= 1;
+        x = f;
+    }
+    return x;
+}
+
+/* Float#round(digits).to_s, of -value.round(digits) with +negate+.
+   Below 1e15 the scaled integer is printed directly : the spacing of the
+   doubles around the rounded value is then finer than 10^-digits, so its
+   shortest representation is that integer shifted by +digits+ decimals. */
+size_t
+LolDaeFormatRounded( char* out, double value, int digits, int negate )
+{
+    const double s = LolDaePow10[digits];
+    char buf[24];
+    char* p = out;
+    double f;
+    unsigned long long k;
+    int binexp, count;
+
+    if ( isnan( value ) || isinf( value ) || value == 0.0 )
+        return LolDaeFormatFloat( out, negate ? -value : value );
+
+    /* float_round_overflow and float_round_underflow of Ruby's float.c */
+    frexp( value, &binexp );
+    if ( digits >= 17 - (binexp > 0 ? binexp / 4 : binexp / 3 - 1) )
+        return LolDaeFormatFloat( out, negate ? -value : value );
+    if ( digits < -(binexp > 0 ? binexp / 3 + 1 : binexp / 4) )
+        return LolDaeFormatFloat( out, negate ? -0.0 : 0.0 );
+
+    f = LolDaeRoundHalfUp( value, s );
+    if ( !(fabs( f ) < 1e15) )
+        return LolDaeFormatFloat( out, negate ? -(f / s) : f / s );
+
+    if ( f == 0.0 )
+        return LolDaeFormatSpecial( out, (signbit( f ) != 0) != (negate != 0) ? -0.0 : 0.0 );
+
+    if ( (f < 0.0) != (negate != 0) )
+        *p++ = '-';
+
+    k = (unsigned long long)fabs( f );
+    count = (int)LolDaeFormatUInt( buf, k );
+
+    /* k / 10^digits = 0.buf x 10^(count - digits) */
+    {
+        int decpt = count - digits;
+        while ( count > 1 && buf[count - 1] == '0' )
+            --count;
+        return (size_t)(p - out) + LolDaeFormatDigits( p, buf, count, decpt );
+    }
+}
+
+/********************************************************************************
+ *
+ * Writer
+ *
+ ********************************************************************************/
+
+void
+LolDaeWriterInit( LolDaeWriter* w, char* buffer, size_t capacity, LolDaeFlushFunc flush, void* context )
+{
+    w->buffer = buffer;
+    w->capacity = capacity;
+    w->length = 0;
+    w->separate = 0;
+    w->flush = flush;
+    w->context = context;
+}
+
+void
+LolDaeWriterFlush( LolDaeWriter* w )
+{
+    size_t length = w->length;
+
+    /* reset first : flush may not return */
+    w->length = 0;
+    if ( length > 0 )
+        w->flush( w->context, w->buffer, length );
+}
+
+void
+LolDaeWriteRaw( LolDaeWriter* w, const char* data, size_t length )
+{
+    while ( length > 0 )
+    {
+        size_t n = w->capacity - w->length;
+
+        if ( n == 0 )
+        {
+            LolDaeWriterFlush( w );
+            continue;
+        }
+        if ( n > length )
+            n = length;
+
+        memcpy( w->buffer + w->length, data, n );
+        w->length += n;
+        data += n;
+        length -= n;
+    }
+}
+
+/* room for one more value and its separator */
+static char*
+LolDaeNextValue( LolDaeWriter* w )
+{
+    if ( w->capacity - w->length < LOL_DAE_NUMBER_SIZE )
+        LolDaeWriterFlush( w );
+
+    if ( w->separate )
+        w->buffer[w->length++] = ' ';
+    w->separate = 1;
+
+    return w->buffer + w->length;
+}
+
+/* the next value starts a new array, without a separator */
+void
+LolDaeBeginArray( LolDaeWriter* w )
+{
+    w->separate = 0;
+}
+
+/* +count+ floats, component c of each +stride+ ones is negated after
+   rounding when bit c of +negate_mask+ is set */
+void
+LolDaeWriteFloats( LolDaeWriter* w, const float* values, size_t count, int stride, int digits, unsigned int negate_mask )
+{
+    size_t i;
+    int c = 0;
+
+    for ( i = 0; i < count; ++i )
+    {
+        char* p = LolDaeNextValue( w );
+
+        w->length += LolDaeFormatRounded( p, (double)values[i], digits, (negate_mask >> c) & 1 );
+        if ( ++c == stride )
+            c = 0;
+    }
+}
+
+/* +count+ uint16, each written +repeat+ times */
+void
+LolDaeWriteIndices( LolDaeWriter* w, const unsigned short* indices, size_t count, int repeat )
+{
+    size_t i;
+    int r;
+
+    for ( i = 0; i < count; ++i )
+    {
+        for ( r = 0; r < repeat; ++r )
+        {
+            char* p = LolDaeNextValue( w );
+            w->length += LolDaeFormatUInt( p, indices[i] );
+        }
+    }
+}
+
+/* first, first + 1, ..., first + count - 1 */
+void
+LolDaeWriteCounter( LolDaeWriter* w, size_t first, size_t count )
+{
+    size_t i;
+
+    for ( i = 0; i < count; ++i )
+    {
+        char* p = LolDaeNextValue( w );
+        w->length += LolDaeFormatUInt( p, (unsigned long long)(first + i) );
+    }
+}
+
+void
+LolDaeWriteRepeated( LolDaeWriter* w, unsigned long value, size_t count )
+{
+    size_t i;
+
+    for ( i = 0; i < count; ++i )
+    {
+        char* p = LolDaeNextValue( w );
+        w->length += LolDaeFormatUInt( p, value );
+    }
+}
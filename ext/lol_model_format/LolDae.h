@@ -0,0 +1,49 @@
+/* -*- C -*- */
+#ifndef LOLDAE_H_INCLUDED
+#define LOLDAE_H_INCLUDED
+
+#include <stddef.h>
+
+/* Writer of the large COLLADA arrays (float_array, p, vcount, v) straight
+   from packed buffers. Values are formatted as Ruby's Float#round(digits)
+   followed by #to_s, or Integer#to_s, separated by single spaces, so the
+   output is the same as Array#join(" ") on the Ruby values. */
+
+#define LOL_DAE_NUMBER_SIZE 32  /* longest formatted value, with its separator */
+#define LOL_DAE_MAX_DIGITS  9
+
+/* hands +length+ bytes over to the output, the buffer is reused afterwards */
+typedef void (*LolDaeFlushFunc)( void* context, const char* data, size_t length );
+
+typedef struct LolDaeWriter
+{
+    char*           buffer;
+    size_t          capacity;   /* at least LOL_DAE_NUMBER_SIZE */
+    size_t          length;
+    int             separate;   /* next value of the array needs a space first */
+    LolDaeFlushFunc flush;
+    void*           context;
+} LolDaeWriter;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t LolDaeFormatFloat( char* out, double value );
+size_t LolDaeFormatRounded( char* out, double value, int digits, int negate );
+
+void   LolDaeWriterInit( LolDaeWriter* w, char* buffer, size_t capacity, LolDaeFlushFunc flush, void* context );
+void   LolDaeWriterFlush( LolDaeWriter* w );
+void   LolDaeWriteRaw( LolDaeWriter* w, const char* data, size_t length );
+
+void   LolDaeBeginArray( LolDaeWriter* w );
+void   LolDaeWriteFloats( LolDaeWriter* w, const float* values, size_t count, int stride, int digits, unsigned int negate_mask );
+void   LolDaeWriteIndices( LolDaeWriter* w, const unsigned short* indices, size_t count, int repeat );
+void   LolDaeWriteCounter( LolDaeWriter* w, size_t first, size_t count );
+void   LolDaeWriteRepeated( LolDaeWriter* w, unsigned long value, size_t count );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
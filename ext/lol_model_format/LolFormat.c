@@ -0,0 +1,484 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define LOL_USE_MMAP 1
+#endif
+
+#include "LolFormat.h"
+
+/********************************************************************************
+ *
+ * Mapped files
+ *
+ ********************************************************************************/
+
+/* Maps the whole file read-only, returns 0 or an errno value.
+   Without mmap the file is read into a malloc'ed buffer instead. */
+int
+LolMappedFileOpen( LolMappedFile* file, const char* path )
+{
+#if defined(LOL_USE_MMAP)
+    struct stat st;
+    void* data;
+    int fd;
+
+    memset( file, 0, sizeof(LolMappedFile) );
+
+    fd = open( path, O_RDONLY );
+    if ( fd < 0 )
+        return errno;
+
+    if ( fstat( fd, &st ) != 0 )
+    {
+        int error = errno;
+        close( fd );
+        return error;
+    }
+
+    if ( st.st_size > 0 )
+    {
+        data = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if ( data == MAP_FAILED )
+        {
+            int error = errno;
+            close( fd );
+            return error;
+        }
+        file->data = (unsigned char*)data;
+        file->size = (size_t)st.st_size;
+        file->mapped = 1;
+    }
+
+    close( fd );
+    return 0;
+#else
+    FILE* fp;
+    long size;
+
+    memset( file, 0, sizeof(LolMappedFile) );
+
+    fp = fopen( path, "rb" );
+    if ( fp == NULL )
+        return errno;
+
+    if ( fseek( fp, 0, SEEK_END ) != 0 || (size = ftell( fp )) < 0 || fseek( fp, 0, SEEK_SET ) != 0 )
+    {
+        int error = errno;
+        fclose( fp );
+        return error;
+    }
+
+    if ( size > 0 )
+    {
+        file->data = (unsigned char*)malloc( (size_t)size );
+        if ( file->data == NULL )
+        {
+            fclose( fp );
+            return ENOMEM;
+        }
+        if ( fread( file->data, 1, (size_t)size, fp ) != (size_t)size )
+        {
+            int error = ferror( fp ) ? errno : EIO;
+            free( file->data );
+            file->data = NULL;
+            fclose( fp );
+            return error;
+        }
+        file->size = (size_t)size;
+    }
+
+    fclose( fp );
+    return 0;
+#endif
+}
+
+void
+LolMappedFileClose( LolMappedFile* file )
+{
+    if ( file->data != NULL )
+    {
+#if defined(LOL_USE_MMAP)
+        if ( file->mapped )
+            munmap( file->data, file->size );
+        else
+#endif
+            free( file->data );
+    }
+
+    memset( file, 0, sizeof(LolMappedFile) );
+}
+
+const char*
+LolFormatErrorString( int error )
+{
+    switch ( error )
+    {
+    case LOL_FORMAT_OK:                  return "no error";
+    case LOL_FORMAT_TRUNCATED:           return "file is truncated";
+    case LOL_FORMAT_UNSUPPORTED_VERSION: return "unsupported version";
+    case LOL_FORMAT_INCONSISTENT:        return "inconsistent header";
+    default:                             return "unknown error";
+    }
+}
+
+/********************************************************************************
+ *
+ * Little-endian reads
+ *
+ ********************************************************************************/
+
+static unsigned int
+LolReadUInt16( const unsigned char* p )
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+unsigned int
+LolReadUInt32( const unsigned char* p )
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+float
+LolReadFloat32( const unsigned char* p )
+{
+    unsigned int bits = LolReadUInt32( p );
+    float f;
+
+    memcpy( &f, &bits, sizeof(float) );
+    return f;
+}
+
+/* length of a fixed size name without its trailing NUL padding */
+size_t
+LolNameLength( const unsigned char* name, size_t size )
+{
+    while ( size > 0 && name[size-1] == '\0' )
+        --size;
+    return size;
+}
+
+/* true if +count+ elements of +element_size+ bytes fit in the file after +offset+ */
+static int
+LolFits( size_t offset, size_t count, size_t element_size, size_t size )
+{
+    if ( offset > size )
+        return 0;
+    return element_size == 0 || count <= (size - offset) / element_size;
+}
+
+/********************************************************************************
+ *
+ * Views
+ *
+ ********************************************************************************/
+
+void
+LolViewSet( LolView* view, const unsigned char* base, size_t count, size_t stride, LolViewType type, int components )
+{
+    view->base = base;
+    view->count = count;
+    view->stride = stride;
+    view->type = type;
+    view->components = components;
+}
+
+size_t
+LolViewTypeSize( LolViewType type )
+{
+    switch ( type )
+    {
+    case LOL_VIEW_UINT8:   return 1;
+    case LOL_VIEW_UINT16:  return 2;
+    case LOL_VIEW_UINT32:  return 4;
+    case LOL_VIEW_FLOAT32: return 4;
+    default:               return 0;
+    }
+}
+
+unsigned int
+LolViewGetUInt( const LolView* view, size_t i, int c )
+{
+    const unsigned char* p = view->base + i * view->stride + c * LolViewTypeSize( view->type );
+
+    switch ( view->type )
+    {
+    case LOL_VIEW_UINT8:   return p[0];
+    case LOL_VIEW_UINT16:  return LolReadUInt16( p );
+    case LOL_VIEW_UINT32:  return LolReadUInt32( p );
+    case LOL_VIEW_FLOAT32: return (unsigned int)LolReadFloat32( p );
+    default:               return 0;
+    }
+}
+
+float
+LolViewGetFloat( const LolView* view, size_t i, int c )
+{
+    const unsigned char* p = view->base + i * view->stride + c * LolViewTypeSize( view->type );
+
+    if ( view->type == LOL_VIEW_FLOAT32 )
+        return LolReadFloat32( p );
+    return (float)LolViewGetUInt( view, i, c );
+}
+
+/* Copies the view into +out+ as a tightly packed array of native values
+   (count * components elements of LolViewTypeSize bytes). */
+void
+LolViewGather( void* out, const LolView* view )
+{
+    size_t type_size = LolViewTypeSize( view->type );
+    size_t row_size = type_size * view->components;
+    unsigned char* dst = (unsigned char*)out;
+    size_t i;
+
+#if defined(LOL_HOST_LITTLE_ENDIAN)
+    if ( view->stride == row_size )
+    {
+        memcpy( dst, view->base, row_size * view->count );
+        return;
+    }
+    for ( i = 0; i < view->count; ++i )
+        memcpy( dst + i * row_size, view->base + i * view->stride, row_size );
+#else
+    for ( i = 0; i < view->count; ++i )
+    {
+        int c;
+        for ( c = 0; c < view->components; ++c )
+        {
+            unsigned char* d = dst + i * row_size + c * type_size;
+            switch ( view->type )
+            {
+            case LOL_VIEW_UINT8:
+                *d = (unsigned char)LolViewGetUInt( view, i, c );
+                break;
+            case LOL_VIEW_UINT16:
+            {
+                unsigned short v = (unsigned short)LolViewGetUInt( view, i, c );
+                memcpy( d, &v, sizeof(v) );
+                break;
+            }
+            case LOL_VIEW_UINT32:
+            {
+                unsigned int v = LolViewGetUInt( view, i, c );
+                memcpy( d, &v, sizeof(v) );
+                break;
+            }
+            case LOL_VIEW_FLOAT32:
+            {
+                float v = LolViewGetFloat( view, i, c );
+                memcpy( d, &v, sizeof(v) );
+                break;
+            }
+            }
+        }
+    }
+#endif
+}
+
+/********************************************************************************
+ *
+ * .skn
+ *
+ ********************************************************************************/
+
+int
+LolSknParse( LolSknLayout* skn, const unsigned char* data, size_t size )
+{
+    size_t offset;
+
+    memset( skn, 0, sizeof(LolSknLayout) );
+
+    if ( size < 12 )
+        return LOL_FORMAT_TRUNCATED;
+
+    skn->magic = LolReadUInt32( data );
+    skn->version = LolReadUInt16( data + 4 );
+    skn->num_of_objects = LolReadUInt16( data + 6 );
+    skn->num_of_material_headers = LolReadUInt32( data + 8 );
+
+    if ( skn->version != 1 && skn->version != 2 )
+        return LOL_FORMAT_UNSUPPORTED_VERSION;
+
+    offset = 12;
+    if ( !LolFits( offset, skn->num_of_material_headers, LOL_SKN_MATERIAL_SIZE, size ) )
+        return LOL_FORMAT_TRUNCATED;
+    skn->material_headers = data + offset;
+    offset += (size_t)skn->num_of_material_headers * LOL_SKN_MATERIAL_SIZE;
+
+    if ( !LolFits( offset, 2, 4, size ) )
+        return LOL_FORMAT_TRUNCATED;
+    skn->num_of_indices = LolReadUInt32( data + offset );
+    skn->num_of_vertices = LolReadUInt32( data + offset + 4 );
+    offset += 8;
+
+    if ( !LolFits( offset, skn->num_of_indices, 2, size ) )
+        return LOL_FORMAT_TRUNCATED;
+    skn->indices = data + offset;
+    offset += (size_t)skn->num_of_indices * 2;
+
+    if ( !LolFits( offset, skn->num_of_vertices, LOL_SKN_VERTEX_SIZE, size ) )
+        return LOL_FORMAT_TRUNCATED;
+    skn->vertices = data + offset;
+    offset += (size_t)skn->num_of_vertices * LOL_SKN_VERTEX_SIZE;
+
+    if ( skn->version == 2 )
+    {
+        if ( !LolFits( offset, LOL_SKN_END_TAB_SIZE, 4, size ) )
+            return LOL_FORMAT_TRUNCATED;
+        skn->end_tab = data + offset;
+    }
+
+    return LOL_FORMAT_OK;
+}
+
+/* view over one attribute of every vertex, +offset+ is the attribute offset in the vertex */
+void
+LolSknVertexView( LolView* view, const LolSknLayout* skn, size_t offset, LolViewType type, int components )
+{
+    LolViewSet( view, skn->vertices + offset, skn->num_of_vertices, LOL_SKN_VERTEX_SIZE, type, components );
+}
+
+/********************************************************************************
+ *
+ * .skl
+ *
+ ********************************************************************************/
+
+int
+LolSklParse( LolSklLayout* skl, const unsigned char* data, size_t size )
+{
+    size_t offset;
+
+    memset( skl, 0, sizeof(LolSklLayout) );
+
+    if ( size < LOL_SKL_ID_SIZE + 12 )
+        return LOL_FORMAT_TRUNCATED;
+
+    skl->id = data;
+    skl->version = LolReadUInt32( data + 8 );
+    skl->designer_id = LolReadUInt32( data + 12 );
+    skl->num_of_bones = LolReadUInt32( data + 16 );
+
+    /* newest version is 0, and it's not fully understood yet */
+    if ( skl->version != 1 && skl->version != 2 )
+        return LOL_FORMAT_UNSUPPORTED_VERSION;
+
+    offset = LOL_SKL_ID_SIZE + 12;
+    if ( !LolFits( offset, skl->num_of_bones, LOL_SKL_BONE_SIZE, size ) )
+        return LOL_FORMAT_TRUNCATED;
+    skl->bones = data + offset;
+    offset += (size_t)skl->num_of_bones * LOL_SKL_BONE_SIZE;
+
+    if ( skl->version == 2 || skl->version == 0 )
+    {
+        if ( !LolFits( offset, 1, 4, size ) )
+            return LOL_FORMAT_TRUNCATED;
+        skl->num_of_bone_ids = LolReadUInt32( data + offset );
+        offset += 4;
+
+        if ( !LolFits( offset, skl->num_of_bone_ids, 4, size ) )
+            return LOL_FORMAT_TRUNCATED;
+        skl->bone_ids = data + offset;
+    }
+
+    return LOL_FORMAT_OK;
+}
+
+/* view over one field of every bone, +offset+ is the field offset in the bone */
+void
+LolSklBoneView( LolView* view, const LolSklLayout* skl, size_t offset, LolViewType type, int components )
+{
+    LolViewSet( view, skl->bones + offset, skl->num_of_bones, LOL_SKL_BONE_SIZE, type, components );
+}
+
+/********************************************************************************
+ *
+ * .anm
+ *
+ ********************************************************************************/
+
+int
+LolAnmParse( LolAnmLayout* anm, const unsigned char* data, size_t size )
+{
+    size_t offset;
+
+    memset( anm, 0, sizeof(LolAnmLayout) );
+
+    if ( size < LOL_ANM_ID_SIZE + 20 )
+        return LOL_FORMAT_TRUNCATED;
+
+    anm->id = data;
+    anm->version = LolReadUInt32( data + 8 );
+    anm->magic = LolReadUInt32( data + 12 );
+    anm->number_of_bones = LolReadUInt32( data + 16 );
+    anm->number_of_frames = LolReadUInt32( data + 20 );
+    anm->playback_fps = LolReadUInt32( data + 24 );
+
+    /* Version 4 and above is not supported yet */
+    if ( anm->version > 3 )
+        return LOL_FORMAT_UNSUPPORTED_VERSION;
+
+    offset = LOL_ANM_ID_SIZE + 20;
+    if ( !LolFits( 0, anm->number_of_frames, LOL_ANM_FRAME_SIZE, size ) )
+        return LOL_FORMAT_TRUNCATED;
+    anm->bone_size = LOL_ANM_BONE_HEADER + (size_t)anm->number_of_frames * LOL_ANM_FRAME_SIZE;
+
+    if ( !LolFits( offset, anm->number_of_bones, anm->bone_size, size ) )
+        return LOL_FORMAT_TRUNCATED;
+    anm->bones = data + offset;
+
+    return LOL_FORMAT_OK;
+}
+
+/* view over the frames of +bone+, 7 floats each (orientation x,y,z,w, position x,y,z) */
+void
+LolAnmTrackView( LolView* view, const LolAnmLayout* anm, unsigned int bone )
+{
+    const unsigned char* frames = anm->bones + bone * anm->bone_size + LOL_ANM_BONE_HEADER;
+
+    LolViewSet( view, frames, anm->number_of_frames, LOL_ANM_FRAME_SIZE, LOL_VIEW_FLOAT32, LOL_ANM_FRAME_STRIDE );
+}
+
+/* Lays the frames out as consecutive poses of +bone_count+ bones (frame-major).
+   Bones beyond the animated ones copy their entry of +bind_pose+. */
+void
+LolAnmGatherPoses( float* poses, const LolAnmLayout* anm, const float* bind_pose, unsigned int bone_count )
+{
+    unsigned int animated = anm->number_of_bones < bone_count ? anm->number_of_bones : bone_count;
+    unsigned int b, f;
+    int c;
+
+    for ( b = 0; b < animated; ++b )
+    {
+        LolView track;
+
+        LolAnmTrackView( &track, anm, b );
+        for ( f = 0; f < anm->number_of_frames; ++f )
+        {
+            float* pose = poses + ((size_t)f * bone_count + b) * LOL_ANM_FRAME_STRIDE;
+#if defined(LOL_HOST_LITTLE_ENDIAN)
+            memcpy( pose, track.base + f * track.stride, LOL_ANM_FRAME_SIZE );
+#else
+            for ( c = 0; c < LOL_ANM_FRAME_STRIDE; ++c )
+                pose[c] = LolViewGetFloat( &track, f, c );
+#endif
+        }
+    }
+
+    for ( b = animated; b < bone_count; ++b )
+    {
+        for ( f = 0; f < anm->number_of_frames; ++f )
+        {
+            float* pose = poses + ((size_t)f * bone_count + b) * LOL_ANM_FRAME_STRIDE;
+            for ( c = 0; c < LOL_ANM_FRAME_STRIDE; ++c )
+                pose[c] = bind_pose[b * LOL_ANM_FRAME_STRIDE + c];
+        }
+    }
+}
@@ -0,0 +1,139 @@
+/* -*- C -*- */
+#ifndef LOLFORMAT_H_INCLUDED
+#define LOLFORMAT_H_INCLUDED
+
+#include <stddef.h>
+
+/* Readers of the .skn/.skl/.anm layouts working directly on the bytes of a
+   file mapped into memory. Parsing only validates the header and records
+   where each table starts; elements are read on demand through LolView. */
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+#   if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#       define LOL_HOST_LITTLE_ENDIAN 1
+#   endif
+#elif defined(_WIN32) || defined(__i386__) || defined(__x86_64__)
+#   define LOL_HOST_LITTLE_ENDIAN 1
+#endif
+
+enum
+{
+    LOL_FORMAT_OK = 0,
+    LOL_FORMAT_TRUNCATED,
+    LOL_FORMAT_UNSUPPORTED_VERSION,
+    LOL_FORMAT_INCONSISTENT
+};
+
+typedef enum LolViewType
+{
+    LOL_VIEW_UINT8,
+    LOL_VIEW_UINT16,
+    LOL_VIEW_UINT32,
+    LOL_VIEW_FLOAT32
+} LolViewType;
+
+/* +count+ elements of +components+ little-endian values each,
+   consecutive elements are +stride+ bytes apart */
+typedef struct LolView
+{
+    const unsigned char* base;
+    size_t               count;
+    size_t               stride;
+    LolViewType          type;
+    int                  components;
+} LolView;
+
+typedef struct LolMappedFile
+{
+    unsigned char* data;
+    size_t         size;
+    int            mapped;  /* data comes from mmap, otherwise from malloc */
+} LolMappedFile;
+
+#define LOL_SKN_MATERIAL_SIZE      80
+#define LOL_SKN_MATERIAL_NAME_SIZE 64
+#define LOL_SKN_VERTEX_SIZE        52
+#define LOL_SKN_END_TAB_SIZE       3
+
+typedef struct LolSknLayout
+{
+    unsigned int         magic;
+    unsigned int         version;
+    unsigned int         num_of_objects;
+    unsigned int         num_of_material_headers;
+    unsigned int         num_of_indices;
+    unsigned int         num_of_vertices;
+    const unsigned char* material_headers;
+    const unsigned char* indices;
+    const unsigned char* vertices;
+    const unsigned char* end_tab;   /* NULL unless version 2 */
+} LolSknLayout;
+
+#define LOL_SKL_ID_SIZE        8
+#define LOL_SKL_BONE_NAME_SIZE 32
+#define LOL_SKL_BONE_SIZE      88
+#define LOL_SKL_TRANSFORM_SIZE 12
+
+typedef struct LolSklLayout
+{
+    const unsigned char* id;
+    unsigned int         version;
+    unsigned int         designer_id;
+    unsigned int         num_of_bones;
+    unsigned int         num_of_bone_ids;
+    const unsigned char* bones;
+    const unsigned char* bone_ids;  /* NULL unless version 2 or 0 */
+} LolSklLayout;
+
+#define LOL_ANM_ID_SIZE        8
+#define LOL_ANM_BONE_NAME_SIZE 32
+#define LOL_ANM_BONE_HEADER    36
+#define LOL_ANM_FRAME_SIZE     28
+#define LOL_ANM_FRAME_STRIDE   7    /* floats per frame, same as RSKELETON_POSE_STRIDE */
+
+typedef struct LolAnmLayout
+{
+    const unsigned char* id;
+    unsigned int         version;
+    unsigned int         magic;
+    unsigned int         number_of_bones;
+    unsigned int         number_of_frames;
+    unsigned int         playback_fps;
+    const unsigned char* bones;
+    size_t               bone_size;
+} LolAnmLayout;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int          LolMappedFileOpen( LolMappedFile* file, const char* path );
+void         LolMappedFileClose( LolMappedFile* file );
+
+const char*  LolFormatErrorString( int error );
+
+unsigned int LolReadUInt32( const unsigned char* p );
+float        LolReadFloat32( const unsigned char* p );
+size_t       LolNameLength( const unsigned char* name, size_t size );
+
+void         LolViewSet( LolView* view, const unsigned char* base, size_t count, size_t stride, LolViewType type, int components );
+size_t       LolViewTypeSize( LolViewType type );
+unsigned int LolViewGetUInt( const LolView* view, size_t i, int c );
+float        LolViewGetFloat( const LolView* view, size_t i, int c );
+void         LolViewGather( void* out, const LolView* view );
+
+int          LolSknParse( LolSknLayout* skn, const unsigned char* data, size_t size );
+void         LolSknVertexView( LolView* view, const LolSknLayout* skn, size_t offset, LolViewType type, int components );
+
+int          LolSklParse( LolSklLayout* skl, const unsigned char* data, size_t size );
+void         LolSklBoneView( LolView* view, const LolSklLayout* skl, size_t offset, LolViewType type, int components );
+
+int          LolAnmParse( LolAnmLayout* anm, const unsigned char* data, size_t size );
+void         LolAnmTrackView( LolView* view, const LolAnmLayout* anm, unsigned int bone );
+void         LolAnmGatherPoses( float* poses, const LolAnmLayout* anm, const float* bind_pose, unsigned int bone_count );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
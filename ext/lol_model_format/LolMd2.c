@@ -0,0 +1,530 @@
+#include <math.h>
+#include <string.h>
+
+#include "LolMd2.h"
+
+/********************************************************************************
+ *
+ * Anorms
+ *
+ ********************************************************************************/
+
+/* anorms.h of Quake 2, the same values as Md2File::Anorms */
+const double LolMd2Anorms[LOL_MD2_NUM_ANORMS][3] =
+{
+    { -0.525731,  0.000000,  0.850651 },
+    { -0.442863,  0.238856,  0.864188 },
+    { -0.295242,  0.000000,  0.955423 },
+    { -0.309017,  0.500000,  0.809017 },
+    { -0.162460,  0.262866,  0.951056 },
+    {  0.000000,  0.000000,  1.000000 },
+    {  0.000000,  0.850651,  0.525731 },
+    { -0.147621,  0.716567,  0.681718 },
+    {  0.147621,  0.716567,  0.681718 },
+    {  0.000000,  0.525731,  0.850651 },
+    {  0.309017,  0.500000,  0.809017 },
+    {  0.525731,  0.000000,  0.850651 },
+    {  0.295242,  0.000000,  0.955423 },
+    {  0.442863,  0.238856,  0.864188 },
+    {  0.162460,  0.262866,  0.951056 },
+    { -0.681718,  0.147621,  0.716567 },
+    { -0.809017,  0.309017,  0.500000 },
+    { -0.587785,  0.425325,  0.688191 },
+    { -0.850651,  0.525731,  0.000000 },
+    { -0.864188,  0.442863,  0.238856 },
+    { -0.716567,  0.681718,  0.147621 },
+    { -0.688191,  0.587785,  0.425325 },
+    { -0.500000,  0.809017,  0.309017 },
+    { -0.238856,  0.864188,  0.442863 },
+    { -0.425325,  0.688191,  0.587785 },
+    { -0.716567,  0.681718, -0.147621 },
+    { -0.500000,  0.809017, -0.309017 },
+    { -0.525731,  0.850651,  0.000000 },
+    {  0.000000,  0.850651, -0.525731 },
+    { -0.238856,  0.864188, -0.442863 },
+    {  0.000000,  0.955423, -0.295242 },
+    { -0.262866,  0.951056, -0.162460 },
+    {  0.000000,  1.000000,  0.000000 },
+    {  0.000000,  0.955423,  0.295242 },
+    { -0.262866,  0.951056,  0.162460 },
+    {  0.238856,  0.864188,  0.442863 },
+    {  0.262866,  0.951056,  0.162460 },
+    {  0.500000,  0.809017,  0.309017 },
+    {  0.238856,  0.864188, -0.442863 },
+    {  0.262866,  0.951056, -0.162460 },
+    {  0.500000,  0.809017, -0.309017 },
+    {  0.850651,  0.525731,  0.000000 },
+    {  0.716567,  0.681718,  0.147621 },
+    {  0.716567,  0.681718, -0.147621 },
+    {  0.525731,  0.850651,  0.000000 },
+    {  0.425325,  0.688191,  0.587785 },
+    {  0.864188,  0.442863,  0.238856 },
+    {  0.688191,  0.587785,  0.425325 },
+    {  0.809017,  0.309017,  0.500000 },
+    {  0.681718,  0.147621,  0.716567 },
+    {  0.587785,  0.425325,  0.688191 },
+    {  0.955423,  0.295242,  0.000000 },
+    {  1.000000,  0.000000,  0.000000 },
+    {  0.951056,  0.162460,  0.262866 },
+    {  0.850651, -0.525731,  0.000000 },
+    {  0.955423, -0.295242,  0.000000 },
+    {  0.864188, -0.442863,  0.238856 },
+    {  0.951056, -0.162460,  0.262866 },
+    {  0.809017, -0.309017,  0.500000 },
+    {  0.681718, -0.147621,  0.716567 },
+    {  0.850651,  0.000000,  0.525731 },
+    {  0.864188,  0.442863, -0.238856 },
+    {  0.809017,  0.309017, -0.500000 },
+    {  0.951056,  0.162460, -0.262866 },
+    {  0.525731,  0.000000, -0.850651 },
+    {  0.681718,  0.147621, -0.716567 },
+    {  0.681718, -0.147621, -0.716567 },
+    {  0.850651,  0.000000, -0.525731 },
+    {  0.809017, -0.309017, -0.500000 },
+    {  0.864188, -0.442863, -0.238856 },
+    {  0.951056, -0.162460, -0.262866 },
+    {  0.147621,  0.716567, -0.681718 },
+    {  0.309017,  0.500000, -0.809017 },
+    {  0.425325,  0.688191, -0.587785 },
+    {  0.442863,  0.238856, -0.864188 },
+    {  0.587785,  0.425325, -0.688191 },
+    {  0.688191,  0.587785, -0.425325 },
+    { -0.147621,  0.716567, -0.681718 },
+    { -0.309017,  0.500000, -0.809017 },
+    {  0.000000,  0.525731, -0.850651 },
+    { -0.525731,  0.000000, -0.850651 },
+    { -0.442863,  0.238856, -0.864188 },
+    { -0.295242,  0.000000, -0.955423 },
+    { -0.162460,  0.262866, -0.951056 },
+    {  0.000000,  0.000000, -1.000000 },
+    {  0.295242,  0.000000, -0.955423 },
+    {  0.162460,  0.262866, -0.951056 },
+    { -0.442863, -0.238856, -0.864188 },
+    { -0.309017, -0.500000, -0.809017 },
+    { -0.162460, -0.262866, -0.951056 },
+    {  0.000000, -0.850651, -0.525731 },
+    { -0.147621, -0.716567, -0.681718 },
+    {  0.147621, -0.716567, -0.681718 },
+    {  0.000000, -0.525731, -0.850651 },
+    {  0.309017, -0.500000, -0.809017 },
+    {  0.442863, -0.238856, -0.864188 },
+    {  0.162460, -0.262866, -0.951056 },
+    {  0.238856, -0.864188, -0.442863 },
+    {  0.500000, -0.809017, -0.309017 },
+    {  0.425325, -0.688191, -0.587785 },
+    {  0.716567, -0.681718, -0.147621 },
+    {  0.688191, -0.587785, -0.425325 },
+    {  0.587785, -0.425325, -0.688191 },
+    {  0.000000, -0.955423, -0.295242 },
+    {  0.000000, -1.000000,  0.000000 },
+    {  0.262866, -0.951056, -0.162460 },
+    {  0.000000, -0.850651,  0.525731 },
+    {  0.000000, -0.955423,  0.295242 },
+    {  0.238856, -0.864188,  0.442863 },
+    {  0.262866, -0.951056,  0.162460 },
+    {  0.500000, -0.809017,  0.309017 },
+    {  0.716567, -0.681718,  0.147621 },
+    {  0.525731, -0.850651,  0.000000 },
+    { -0.238856, -0.864188, -0.442863 },
+    { -0.500000, -0.809017, -0.309017 },
+    { -0.262866, -0.951056, -0.162460 },
+    { -0.850651, -0.525731,  0.000000 },
+    { -0.716567, -0.681718, -0.147621 },
+    { -0.716567, -0.681718,  0.147621 },
+    { -0.525731, -0.850651,  0.000000 },
+    { -0.500000, -0.809017,  0.309017 },
+    { -0.238856, -0.864188,  0.442863 },
+    { -0.262866, -0.951056,  0.162460 },
+    { -0.864188, -0.442863,  0.238856 },
+    { -0.809017, -0.309017,  0.500000 },
+    { -0.688191, -0.587785,  0.425325 },
+    { -0.681718, -0.147621,  0.716567 },
+    { -0.442863, -0.238856,  0.864188 },
+    { -0.587785, -0.425325,  0.688191 },
+    { -0.309017, -0.500000,  0.809017 },
+    { -0.147621, -0.716567,  0.681718 },
+    { -0.425325, -0.688191,  0.587785 },
+    { -0.162460, -0.262866,  0.951056 },
+    {  0.442863, -0.238856,  0.864188 },
+    {  0.162460, -0.262866,  0.951056 },
+    {  0.309017, -0.500000,  0.809017 },
+    {  0.147621, -0.716567,  0.681718 },
+    {  0.000000, -0.525731,  0.850651 },
+    {  0.425325, -0.688191,  0.587785 },
+    {  0.587785, -0.425325,  0.688191 },
+    {  0.688191, -0.587785,  0.425325 },
+    { -0.955423,  0.295242,  0.000000 },
+    { -0.951056,  0.162460,  0.262866 },
+    { -1.000000,  0.000000,  0.000000 },
+    { -0.850651,  0.000000,  0.525731 },
+    { -0.955423, -0.295242,  0.000000 },
+    { -0.951056, -0.162460,  0.262866 },
+    { -0.864188,  0.442863, -0.238856 },
+    { -0.951056,  0.162460, -0.262866 },
+    { -0.809017,  0.309017, -0.500000 },
+    { -0.864188, -0.442863, -0.238856 },
+    { -0.951056, -0.162460, -0.262866 },
+    { -0.809017, -0.309017, -0.500000 },
+    { -0.681718,  0.147621, -0.716567 },
+    { -0.681718, -0.147621, -0.716567 },
+    { -0.850651,  0.000000, -0.525731 },
+    { -0.688191,  0.587785, -0.425325 },
+    { -0.587785,  0.425325, -0.688191 },
+    { -0.425325,  0.688191, -0.587785 },
+    { -0.425325, -0.688191, -0.587785 },
+    { -0.587785, -0.425325, -0.688191 },
+    { -0.688191, -0.587785, -0.425325 },
+};
+
+/* Md2File.get_anorms_index : the nearest anorm among those having the same
+   signs as the normal, the first one on ties. -1 if there is none. */
+int
+LolMd2AnormIndexExact( double x, double y, double z )
+{
+    double best_distance = 0.0;
+    int best = -1;
+    int i;
+
+    for ( i = 0; i < LOL_MD2_NUM_ANORMS; ++i )
+    {
+        const double* n = LolMd2Anorms[i];
+        double distance;
+
+        if ( !(n[0] * x >= 0 && n[1] * y >= 0 && n[2] * z >= 0) )
+            continue;
+
+        distance = (n[0] - x) * (n[0] - x) + (n[1] - y) * (n[1] - y) + (n[2] - z) * (n[2] - z);
+        if ( best < 0 || distance < best_distance )
+        {
+            best = i;
+            best_distance = distance;
+        }
+    }
+
+    return best;
+}
+
+/********************************************************************************
+ *
+ * Cube map lookup
+ *
+ ********************************************************************************/
+
+/* Each face of a cube around the origin is split into GRID x GRID cells.
+   A cell keeps the anorms that can be the nearest one to a normal pointing
+   through it, in index order. Others are dropped only when another anorm of
+   the same signs is provably nearer for every direction of the cell and
+   every length of the normal in [MIN_LENGTH, MAX_LENGTH], so scanning the
+   cell gives the same index as LolMd2AnormIndexExact. Normals outside of
+   that range, or with a component (nearly) zero, which widens the sign
+   filter, take the exact path. */
+
+#define LOL_MD2_GRID        16
+#define LOL_MD2_MIN_LENGTH  0.5
+#define LOL_MD2_MAX_LENGTH  4.0
+#define LOL_MD2_TINY        1.0e-300
+#define LOL_MD2_CELL_MARGIN 1.0e-12     /* covers the rounding of the cell index */
+#define LOL_MD2_GAP         1.0e-9      /* covers the rounding of the distances */
+#define LOL_MD2_POOL_SIZE   16384
+
+typedef struct LolMd2Cell
+{
+    unsigned short first;
+    unsigned short count;   /* 0 : exact path */
+} LolMd2Cell;
+
+static LolMd2Cell    LolMd2Cells[6][LOL_MD2_GRID][LOL_MD2_GRID];
+static unsigned char LolMd2Pool[LOL_MD2_POOL_SIZE];
+static int           LolMd2TableReady = 0;
+
+static double
+LolMd2Dot( const double* a, const double* b )
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/* true if anorm +b+ is nearer than anorm +a+ for any normal of length at
+   least MIN_LENGTH through the cell spanned by +corners+ */
+static int
+LolMd2Dominates( const double* b, const double* a, const double corners[4][3], double max_corner_length )
+{
+    double d[3], lower, needed;
+    int c;
+
+    d[0] = b[0] - a[0];
+    d[1] = b[1] - a[1];
+    d[2] = b[2] - a[2];
+
+    /* d.p is linear on the face, so its minimum is at a corner */
+    lower = LolMd2Dot( d, corners[0] );
+    for ( c = 1; c < 4; ++c )
+    {
+        double dp = LolMd2Dot( d, corners[c] );
+        if ( dp < lower )
+            lower = dp;
+    }
+    if ( lower <= 0.0 )
+        return 0;
+
+    /* |a - n|^2 - |b - n|^2 = |a|^2 - |b|^2 + 2 |n| d.(n / |n|) */
+    lower /= max_corner_length;
+    needed = LolMd2Dot( b, b ) - LolMd2Dot( a, a );
+    if ( needed < 0.0 )
+        needed = 0.0;
+
+    return 2.0 * LOL_MD2_MIN_LENGTH * lower > needed + LOL_MD2_GAP;
+}
+
+static void
+LolMd2BuildCell( LolMd2Cell* cell, int axis, double axis_sign, int iu, int iv, size_t* pool_used )
+{
+    const int ua = (axis + 1) % 3;
+    const int va = (axis + 2) % 3;
+    const double width = 2.0 / LOL_MD2_GRID;
+    double u0 = -1.0 + iu * width - LOL_MD2_CELL_MARGIN, u1 = -1.0 + (iu + 1) * width + LOL_MD2_CELL_MARGIN;
+    double v0 = -1.0 + iv * width - LOL_MD2_CELL_MARGIN, v1 = -1.0 + (iv + 1) * width + LOL_MD2_CELL_MARGIN;
+    double corners[4][3];
+    double signs[3];
+    double length, max_corner_length = 0.0;
+    int candidates[LOL_MD2_NUM_ANORMS];
+    int count = 0;
+    int i, j, c;
+
+    signs[axis] = axis_sign;
+    signs[ua] = iu >= LOL_MD2_GRID / 2 ? 1.0 : -1.0;
+    signs[va] = iv >= LOL_MD2_GRID / 2 ? 1.0 : -1.0;
+
+    for ( c = 0; c < 4; ++c )
+    {
+        corners[c][axis] = axis_sign;
+        corners[c][ua] = (c & 1) ? u1 : u0;
+        corners[c][va] = (c & 2) ? v1 : v0;
+        length = sqrt( LolMd2Dot( corners[c], corners[c] ) );
+        if ( length > max_corner_length )
+            max_corner_length = length;
+    }
+
+    for ( i = 0; i < LOL_MD2_NUM_ANORMS; ++i )
+    {
+        const double* n = LolMd2Anorms[i];
+        if ( n[0] * signs[0] >= 0 && n[1] * signs[1] >= 0 && n[2] * signs[2] >= 0 )
+            candidates[count++] = i;
+    }
+
+    cell->first = 0;
+    cell->count = 0;
+
+    for ( i = 0; i < count; ++i )
+    {
+        int dominated = 0;
+
+        for ( j = 0; j < count && !dominated; ++j )
+        {
+            if ( j != i )
+                dominated = LolMd2Dominates( LolMd2Anorms[candidates[j]], LolMd2Anorms[candidates[i]],
+                                             (const double (*)[3])corners, max_corner_length );
+        }
+        if ( dominated )
+            continue;
+
+        if ( *pool_used >= LOL_MD2_POOL_SIZE )
+        {
+            cell->count = 0;
+            return;
+        }
+        if ( cell->count == 0 )
+            cell->first = (unsigned short)*pool_used;
+        LolMd2Pool[(*pool_used)++] = (unsigned char)candidates[i];
+        ++cell->count;
+    }
+}
+
+/* Builds the cube map, once before any LolMd2AnormIndex call that should
+   use it. Until then LolMd2AnormIndex takes the exact path. */
+void
+LolMd2AnormTableInit( void )
+{
+    size_t pool_used = 0;
+    int face, iu, iv;
+
+    if ( LolMd2TableReady )
+        return;
+
+    for ( face = 0; face < 6; ++face )
+        for ( iu = 0; iu < LOL_MD2_GRID; ++iu )
+            for ( iv = 0; iv < LOL_MD2_GRID; ++iv )
+                LolMd2BuildCell( &LolMd2Cells[face][iu][iv], face / 2, (face & 1) ? -1.0 : 1.0, iu, iv, &pool_used );
+
+    LolMd2TableReady = 1;
+}
+
+static int
+LolMd2CellIndex( double t )
+{
+    int i = (int)( (t + 1.0) * 0.5 * LOL_MD2_GRID );
+
+    if ( i >= LOL_MD2_GRID )
+        i = LOL_MD2_GRID - 1;
+    if ( i < 0 )
+        i = 0;
+
+    /* the cell must be on the same side as t, whatever the rounding */
+    if ( t < 0.0 && i >= LOL_MD2_GRID / 2 )
+        i = LOL_MD2_GRID / 2 - 1;
+    if ( t > 0.0 && i < LOL_MD2_GRID / 2 )
+        i = LOL_MD2_GRID / 2;
+
+    return i;
+}
+
+/* Same result as LolMd2AnormIndexExact, scanning a few anorms only */
+int
+LolMd2AnormIndex( double x, double y, double z )
+{
+    const double n[3] = { x, y, z };
+    const double length2 = x * x + y * y + z * z;
+    const LolMd2Cell* cell;
+    double best_distance = 0.0;
+    int best = -1;
+    int axis, i;
+
+    if ( !LolMd2TableReady
+      || !(length2 >= LOL_MD2_MIN_LENGTH * LOL_MD2_MIN_LENGTH && length2 <= LOL_MD2_MAX_LENGTH * LOL_MD2_MAX_LENGTH)
+      || fabs( x ) < LOL_MD2_TINY || fabs( y ) < LOL_MD2_TINY || fabs( z ) < LOL_MD2_TINY )
+        return LolMd2AnormIndexExact( x, y, z );
+
+    axis = 0;
+    if ( fabs( n[1] ) > fabs( n[axis] ) )
+        axis = 1;
+    if ( fabs( n[2] ) > fabs( n[axis] ) )
+        axis = 2;
+
+    cell = &LolMd2Cells[axis * 2 + (n[axis] < 0.0 ? 1 : 0)]
+                       [LolMd2CellIndex( n[(axis + 1) % 3] / fabs( n[axis] ) )]
+                       [LolMd2CellIndex( n[(axis + 2) % 3] / fabs( n[axis] ) )];
+    if ( cell->count == 0 )
+        return LolMd2AnormIndexExact( x, y, z );
+
+    for ( i = cell->first; i < cell->first + cell->count; ++i )
+    {
+        const double* a = LolMd2Anorms[LolMd2Pool[i]];
+        double distance = (a[0] - x) * (a[0] - x) + (a[1] - y) * (a[1] - y) + (a[2] - z) * (a[2] - z);
+
+        if ( best < 0 || distance < best_distance )
+        {
+            best = LolMd2Pool[i];
+            best_distance = distance;
+        }
+    }
+
+    return best;
+}
+
+/********************************************************************************
+ *
+ * Frames
+ *
+ ********************************************************************************/
+
+static void
+LolMd2WriteFloat32( unsigned char* p, float f )
+{
+    unsigned int u;
+
+    memcpy( &u, &f, sizeof(u) );
+    p[0] = (unsigned char)( u & 0xff );
+    p[1] = (unsigned char)( (u >> 8) & 0xff );
+    p[2] = (unsigned char)( (u >> 16) & 0xff );
+    p[3] = (unsigned char)( (u >> 24) & 0xff );
+}
+
+/* bytes of a Md2File::Frame of +count+ vertices */
+size_t
+LolMd2FrameSize( size_t count )
+{
+    return LOL_MD2_FRAME_HEADER_SIZE + count * LOL_MD2_VERTEX_SIZE;
+}
+
+/* Writes the Md2File::Frame record of +count+ vertices (3 floats of
+   +positions+ and of +normals+ each) into +frame+, LolMd2FrameSize bytes.
+   As Md2Model#get_md2_frame, the bounding box is centered on the origin
+   and spans the largest absolute coordinate of each axis, coordinates are
+   truncated then clamped into 0..255 as BinData does for uint8.
+   On error, +error_index+ receives the offending vertex. */
+int
+LolMd2QuantizeFrame( unsigned char* frame, const char* name, size_t name_length,
+                     const float* positions, const float* normals, size_t count, size_t* error_index )
+{
+    double scale[3], translate[3];
+    unsigned char* vertex;
+    size_t i;
+    int c;
+
+    if ( count == 0 )
+        return LOL_MD2_NO_VERTICES;
+
+    for ( c = 0; c < 3; ++c )
+    {
+        double max = positions[c];
+
+        /* the first of the largest ones, as max_by */
+        for ( i = 1; i < count; ++i )
+        {
+            double p = positions[i * 3 + c];
+            if ( fabs( p ) > fabs( max ) )
+                max = p;
+        }
+
+        scale[c] = 2.0 * max / 256.0;
+        translate[c] = -max;
+
+        LolMd2WriteFloat32( frame + c * 4, (float)scale[c] );
+        LolMd2WriteFloat32( frame + 12 + c * 4, (float)translate[c] );
+    }
+
+    memset( frame + 24, 0, LOL_MD2_FRAME_NAME_SIZE );
+    memcpy( frame + 24, name, name_length < LOL_MD2_FRAME_NAME_SIZE ? name_length : LOL_MD2_FRAME_NAME_SIZE );
+
+    vertex = frame + LOL_MD2_FRAME_HEADER_SIZE;
+    for ( i = 0; i < count; ++i, vertex += LOL_MD2_VERTEX_SIZE )
+    {
+        const float* p = positions + i * 3;
+        const float* n = normals + i * 3;
+        int normal_index;
+
+        for ( c = 0; c < 3; ++c )
+        {
+            double v = ( (double)p[c] - translate[c] ) / scale[c];
+
+            if ( !isfinite( v ) )
+            {
+                *error_index = i;
+                return LOL_MD2_NOT_FINITE;
+            }
+            vertex[c] = v >= 255.0 ? 255 : v <= 0.0 ? 0 : (unsigned char)v;
+        }
+
+        normal_index = LolMd2AnormIndex( n[0], n[1], n[2] );
+        if ( normal_index < 0 )
+        {
+            *error_index = i;
+            return LOL_MD2_NO_ANORM;
+        }
+        vertex[3] = (unsigned char)normal_index;
+    }
+
+    return LOL_MD2_OK;
+}
+
+const char*
+LolMd2ErrorString( int error )
+{
+    switch ( error )
+    {
+    case LOL_MD2_OK:            return "no error";
+    case LOL_MD2_NO_VERTICES:   return "no vertices";
+    case LOL_MD2_NOT_FINITE:    return "position cannot be quantized";
+    case LOL_MD2_NO_ANORM:      return "no anorm for normal";
+    default:                    return "unknown error";
+    }
+}
@@ -0,0 +1,44 @@
+/* -*- C -*- */
+#ifndef LOLMD2_H_INCLUDED
+#define LOLMD2_H_INCLUDED
+
+#include <stddef.h>
+
+/* Quantizer of skinned vertices into MD2 frames, as Md2Model#get_md2_frame
+   and Md2File.get_anorms_index do in Ruby, giving the same bytes. */
+
+#define LOL_MD2_NUM_ANORMS        162
+#define LOL_MD2_FRAME_NAME_SIZE   16
+#define LOL_MD2_FRAME_HEADER_SIZE 40    /* scale, translate, name */
+#define LOL_MD2_VERTEX_SIZE       4     /* v[3], normal_index */
+
+enum
+{
+    LOL_MD2_OK = 0,
+    LOL_MD2_NO_VERTICES,
+    LOL_MD2_NOT_FINITE,     /* a position cannot be quantized */
+    LOL_MD2_NO_ANORM        /* no anorm has the same signs as a normal */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const double LolMd2Anorms[LOL_MD2_NUM_ANORMS][3];
+
+void        LolMd2AnormTableInit( void );
+
+int         LolMd2AnormIndexExact( double x, double y, double z );
+int         LolMd2AnormIndex( double x, double y, double z );
+
+size_t      LolMd2FrameSize( size_t count );
+int         LolMd2QuantizeFrame( unsigned char* frame, const char* name, size_t name_length,
+                                 const float* positions, const float* normals, size_t count, size_t* error_index );
+
+const char* LolMd2ErrorString( int error );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
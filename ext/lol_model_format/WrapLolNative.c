@@ -0,0 +1,1318 @@
+#include <ruby.h>
+#include <ruby/encoding.h>
+#include <errno.h>
+#include <string.h>
+#if defined(HAVE_RUBY_THREAD_H)
+#include <ruby/thread.h>
+#endif
+
+#include "LolFormat.h"
+#include "LolMd2.h"
+#include "LolDae.h"
+
+/********************************************************************************
+ *
+ * Common Settings
+ *
+ ********************************************************************************/
+
+VALUE rb_mLolModelFormat;
+VALUE rb_mLolNative;
+VALUE rb_eLolFormatError;
+VALUE rb_cLolMappedFile;
+VALUE rb_cLolView;
+VALUE rb_cLolSknMap;
+VALUE rb_cLolSklMap;
+VALUE rb_cLolAnmMap;
+VALUE rb_cLolDaeWriter;
+
+/* LOL_NATIVE_EXPORT
+ * (for Init_LolNative to avoid LoadError on +require+)
+ */
+#ifndef LOL_NATIVE_EXPORT
+#if defined(_WIN32) || defined(WIN32) || defined(__CYGWIN__)
+#   define LOL_NATIVE_EXPORT __declspec(dllexport)
+#else
+#   define LOL_NATIVE_EXPORT
+#endif
+#endif /* LOL_NATIVE_EXPORT */
+
+/* LOL_NATIVE_WITHOUT_GVL
+ * (runs the quantizer with the GVL released where the C API allows it)
+ */
+#if defined(HAVE_RB_THREAD_CALL_WITHOUT_GVL)
+#   define LOL_NATIVE_WITHOUT_GVL( func, data ) rb_thread_call_without_gvl( (func), (data), NULL, NULL )
+#else
+#   define LOL_NATIVE_WITHOUT_GVL( func, data ) (func)( (data) )
+#endif
+
+typedef struct LolNativeMap
+{
+    LolMappedFile file;
+    int           open;
+    union
+    {
+        LolSknLayout skn;
+        LolSklLayout skl;
+        LolAnmLayout anm;
+    } layout;
+} LolNativeMap;
+
+typedef struct LolNativeView
+{
+    VALUE   owner;  /* the mapped file the view points into */
+    LolView view;
+} LolNativeView;
+
+typedef int (*LolParseFunc)( void* layout, const unsigned char* data, size_t size );
+
+static void
+LolNativeMap_free( void* ptr )
+{
+    LolNativeMap* map = (LolNativeMap*)ptr;
+
+    LolMappedFileClose( &map->file );
+    xfree( map );
+}
+
+/* the file is counted when read into memory, not when mapped */
+static size_t
+LolNativeMap_memsize( const void* ptr )
+{
+    const LolNativeMap* map = (const LolNativeMap*)ptr;
+
+    return sizeof(LolNativeMap) + ( map->file.mapped ? 0 : map->file.size );
+}
+
+static const rb_data_type_t LolNativeMap_data_type =
+{
+    "LolModelFormat::Native::MappedFile",
+    { 0, LolNativeMap_free, LolNativeMap_memsize, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static LolNativeMap*
+LolNativeMap_get( VALUE self )
+{
+    LolNativeMap* map;
+
+    TypedData_Get_Struct( self, LolNativeMap, &LolNativeMap_data_type, map );
+    if ( !map->open )
+        rb_raise( rb_eIOError, "closed mapped file" );
+
+    return map;
+}
+
+static VALUE
+LolNativeName( const unsigned char* name, size_t size )
+{
+    return rb_str_new( (const char*)name, (long)LolNameLength( name, size ) );
+}
+
+/********************************************************************************
+ *
+ * LolModelFormat::Native::View
+ *
+ ********************************************************************************/
+
+static void
+LolNativeView_mark( void* ptr )
+{
+    LolNativeView* v = (LolNativeView*)ptr;
+
+    rb_gc_mark( v->owner );
+}
+
+static void
+LolNativeView_free( void* ptr )
+{
+    xfree( ptr );
+}
+
+static size_t
+LolNativeView_memsize( const void* ptr )
+{
+    return sizeof(LolNativeView);
+}
+
+static const rb_data_type_t LolNativeView_data_type =
+{
+    "LolModelFormat::Native::View",
+    { LolNativeView_mark, LolNativeView_free, LolNativeView_memsize, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE
+LolNativeView_new( VALUE owner, const LolView* view )
+{
+    LolNativeView* v = ALLOC( LolNativeView );
+
+    v->owner = owner;
+    v->view = *view;
+
+    return TypedData_Wrap_Struct( rb_cLolView, &LolNativeView_data_type, v );
+}
+
+static const LolView*
+LolNativeView_get( VALUE self )
+{
+    LolNativeView* v;
+
+    TypedData_Get_Struct( self, LolNativeView, &LolNativeView_data_type, v );
+    LolNativeMap_get( v->owner );
+
+    return &v->view;
+}
+
+static VALUE
+LolNativeView_value( const LolView* view, size_t i, int c )
+{
+    if ( view->type == LOL_VIEW_FLOAT32 )
+        return DBL2NUM( (double)LolViewGetFloat( view, i, c ) );
+    return UINT2NUM( LolViewGetUInt( view, i, c ) );
+}
+
+static VALUE
+LolNativeView_element( const LolView* view, size_t i )
+{
+    VALUE ary;
+    int c;
+
+    if ( view->components == 1 )
+        return LolNativeView_value( view, i, 0 );
+
+    ary = rb_ary_new2( view->components );
+    for ( c = 0; c < view->components; ++c )
+        rb_ary_push( ary, LolNativeView_value( view, i, c ) );
+
+    return ary;
+}
+
+/*
+ * call-seq: size -> count
+ *
+ * Returns the number of elements.
+ */
+static VALUE
+LolNativeView_size( VALUE self )
+{
+    return SIZET2NUM( LolNativeView_get( self )->count );
+}
+
+/*
+ * call-seq: components -> count
+ *
+ * Returns the number of values of each element.
+ */
+static VALUE
+LolNativeView_components( VALUE self )
+{
+    return INT2NUM( LolNativeView_get( self )->components );
+}
+
+/*
+ * call-seq: type -> :uint8, :uint16, :uint32 or :float
+ *
+ * Returns the type of the values, as the BinData field type.
+ */
+static VALUE
+LolNativeView_type( VALUE self )
+{
+    switch ( LolNativeView_get( self )->type )
+    {
+    case LOL_VIEW_UINT8:   return ID2SYM( rb_intern( "uint8" ) );
+    case LOL_VIEW_UINT16:  return ID2SYM( rb_intern( "uint16" ) );
+    case LOL_VIEW_UINT32:  return ID2SYM( rb_intern( "uint32" ) );
+    default:               return ID2SYM( rb_intern( "float" ) );
+    }
+}
+
+/*
+ * call-seq: view[i] -> value, [values] or nil
+ *
+ * Reads the +i+-th element from the mapped bytes. Elements of more than one
+ * component are returned as an Array. Negative indices count from the end.
+ */
+static VALUE
+LolNativeView_aref( VALUE self, VALUE index )
+{
+    const LolView* view = LolNativeView_get( self );
+    long i = NUM2LONG( index );
+
+    if ( i < 0 )
+        i += (long)view->count;
+    if ( i < 0 || (size_t)i >= view->count )
+        return Qnil;
+
+    return LolNativeView_element( view, (size_t)i );
+}
+
+/*
+ * call-seq: each { |element| ... } -> self
+ */
+static VALUE
+LolNativeView_each( VALUE self )
+{
+    size_t i;
+
+    RETURN_ENUMERATOR( self, 0, 0 );
+
+    for ( i = 0; i < LolNativeView_get( self )->count; ++i )
+        rb_yield( LolNativeView_element( LolNativeView_get( self ), i ) );
+
+    return self;
+}
+
+/*
+ * call-seq: packed -> String
+ *
+ * Copies all the values into a String of native values, as
+ * Array#pack('C*'), 'S*', 'L*' or 'f*' would, without creating an object
+ * per value.
+ */
+static VALUE
+LolNativeView_packed( VALUE self )
+{
+    const LolView* view = LolNativeView_get( self );
+    VALUE str = rb_str_new( NULL, (long)(view->count * view->components * LolViewTypeSize( view->type )) );
+
+    LolViewGather( RSTRING_PTR( str ), view );
+
+    return str;
+}
+
+/********************************************************************************
+ *
+ * LolModelFormat::Native::MappedFile
+ *
+ ********************************************************************************/
+
+static VALUE
+LolNativeMap_allocate( VALUE klass )
+{
+    LolNativeMap* map = ALLOC( LolNativeMap );
+
+    memset( map, 0, sizeof(LolNativeMap) );
+
+    return TypedData_Wrap_Struct( klass, &LolNativeMap_data_type, map );
+}
+
+static VALUE
+LolNativeMap_map( VALUE self, VALUE path, LolParseFunc parse, const char* class_name )
+{
+    LolNativeMap* map;
+    int error;
+
+    TypedData_Get_Struct( self, LolNativeMap, &LolNativeMap_data_type, map );
+    FilePathValue( path );
+
+    LolMappedFileClose( &map->file );
+    map->open = 0;
+
+    error = LolMappedFileOpen( &map->file, StringValueCStr( path ) );
+    if ( error != 0 )
+    {
+        errno = error;
+        rb_sys_fail( StringValueCStr( path ) );
+    }
+
+    error = parse( &map->layout, map->file.data, map->file.size );
+    if ( error != LOL_FORMAT_OK )
+    {
+        LolMappedFileClose( &map->file );
+        rb_raise( rb_eLolFormatError, "%s#initialize : %s (%s)", class_name, LolFormatErrorString( error ), StringValueCStr( path ) );
+    }
+
+    map->open = 1;
+
+    return self;
+}
+
+/*
+ * call-seq: close -> nil
+ *
+ * Unmaps the file. Views created from it raise IOError afterwards.
+ */
+static VALUE
+LolNativeMap_close( VALUE self )
+{
+    LolNativeMap* map;
+
+    TypedData_Get_Struct( self, LolNativeMap, &LolNativeMap_data_type, map );
+    LolMappedFileClose( &map->file );
+    map->open = 0;
+
+    return Qnil;
+}
+
+/*
+ * call-seq: closed? -> true or false
+ */
+static VALUE
+LolNativeMap_closed( VALUE self )
+{
+    LolNativeMap* map;
+
+    TypedData_Get_Struct( self, LolNativeMap, &LolNativeMap_data_type, map );
+
+    return map->open ? Qfalse : Qtrue;
+}
+
+/*
+ * call-seq: bytesize -> size of the mapped file
+ */
+static VALUE
+LolNativeMap_bytesize( VALUE self )
+{
+    return SIZET2NUM( LolNativeMap_get( self )->file.size );
+}
+
+/*
+ * call-seq:
+ *   open(path) -> map
+ *   open(path) { |map| ... } -> result of the block
+ *
+ * With a block the file is unmapped when the block returns.
+ */
+static VALUE
+LolNativeMap_s_open( int argc, VALUE* argv, VALUE klass )
+{
+    VALUE map = rb_class_new_instance( argc, argv, klass );
+
+    if ( rb_block_given_p() )
+        return rb_ensure( rb_yield, map, LolNativeMap_close, map );
+
+    return map;
+}
+
+/********************************************************************************
+ *
+ * LolModelFormat::Native::SknMap
+ *
+ ********************************************************************************/
+
+#define LOL_SKN( self ) (&LolNativeMap_get( self )->layout.skn)
+
+static int
+LolSknParse_func( void* layout, const unsigned char* data, size_t size )
+{
+    return LolSknParse( (LolSknLayout*)layout, data, size );
+}
+
+/*
+ * call-seq: SknMap.new(path)
+ *
+ * Maps a .skn file, raises FormatError unless it is a version 1 or 2 skin.
+ */
+static VALUE
+LolSknMap_initialize( VALUE self, VALUE path )
+{
+    return LolNativeMap_map( self, path, LolSknParse_func, "LolModelFormat::Native::SknMap" );
+}
+
+static VALUE LolSknMap_magic( VALUE self ) { return UINT2NUM( LOL_SKN( self )->magic ); }
+static VALUE LolSknMap_version( VALUE self ) { return UINT2NUM( LOL_SKN( self )->version ); }
+static VALUE LolSknMap_num_of_objects( VALUE self ) { return UINT2NUM( LOL_SKN( self )->num_of_objects ); }
+static VALUE LolSknMap_num_of_material_headers( VALUE self ) { return UINT2NUM( LOL_SKN( self )->num_of_material_headers ); }
+static VALUE LolSknMap_num_of_indices( VALUE self ) { return UINT2NUM( LOL_SKN( self )->num_of_indices ); }
+static VALUE LolSknMap_num_of_vertices( VALUE self ) { return UINT2NUM( LOL_SKN( self )->num_of_vertices ); }
+
+/*
+ * call-seq: material_headers -> [{ :name, :start_vertex, :num_vertices, :start_index, :num_of_indices }, ...]
+ */
+static VALUE
+LolSknMap_material_headers( VALUE self )
+{
+    const LolSknLayout* skn = LOL_SKN( self );
+    VALUE ary = rb_ary_new2( skn->num_of_material_headers );
+    unsigned int i;
+
+    for ( i = 0; i < skn->num_of_material_headers; ++i )
+    {
+        const unsigned char* p = skn->material_headers + (size_t)i * LOL_SKN_MATERIAL_SIZE;
+        const unsigned char* counts = p + LOL_SKN_MATERIAL_NAME_SIZE;
+        VALUE material = rb_hash_new();
+
+        rb_hash_aset( material, ID2SYM( rb_intern( "name" ) ), LolNativeName( p, LOL_SKN_MATERIAL_NAME_SIZE ) );
+        rb_hash_aset( material, ID2SYM( rb_intern( "start_vertex" ) ), UINT2NUM( LolReadUInt32( counts ) ) );
+        rb_hash_aset( material, ID2SYM( rb_intern( "num_vertices" ) ), UINT2NUM( LolReadUInt32( counts + 4 ) ) );
+        rb_hash_aset( material, ID2SYM( rb_intern( "start_index" ) ), UINT2NUM( LolReadUInt32( counts + 8 ) ) );
+        rb_hash_aset( material, ID2SYM( rb_intern( "num_of_indices" ) ), UINT2NUM( LolReadUInt32( counts + 12 ) ) );
+        rb_ary_push( ary, material );
+    }
+
+    return ary;
+}
+
+/*
+ * call-seq: indices -> View of uint16
+ */
+static VALUE
+LolSknMap_indices( VALUE self )
+{
+    const LolSknLayout* skn = LOL_SKN( self );
+    LolView view;
+
+    LolViewSet( &view, skn->indices, skn->num_of_indices, 2, LOL_VIEW_UINT16, 1 );
+
+    return LolNativeView_new( self, &view );
+}
+
+static VALUE
+LolSknMap_vertex_view( VALUE self, size_t offset, LolViewType type, int components )
+{
+    LolView view;
+
+    LolSknVertexView( &view, LOL_SKN( self ), offset, type, components );
+
+    return LolNativeView_new( self, &view );
+}
+
+/*
+ * call-seq: positions -> View of 3 floats per vertex
+ */
+static VALUE LolSknMap_positions( VALUE self ) { return LolSknMap_vertex_view( self, 0, LOL_VIEW_FLOAT32, 3 ); }
+
+/*
+ * call-seq: bone_indices -> View of 4 uint8 per vertex
+ */
+static VALUE LolSknMap_bone_indices( VALUE self ) { return LolSknMap_vertex_view( self, 12, LOL_VIEW_UINT8, 4 ); }
+
+/*
+ * call-seq: weights -> View of 4 floats per vertex
+ */
+static VALUE LolSknMap_weights( VALUE self ) { return LolSknMap_vertex_view( self, 16, LOL_VIEW_FLOAT32, 4 ); }
+
+/*
+ * call-seq: normals -> View of 3 floats per vertex
+ */
+static VALUE LolSknMap_normals( VALUE self ) { return LolSknMap_vertex_view( self, 32, LOL_VIEW_FLOAT32, 3 ); }
+
+/*
+ * call-seq: tex_coords -> View of 2 floats per vertex
+ */
+static VALUE LolSknMap_tex_coords( VALUE self ) { return LolSknMap_vertex_view( self, 44, LOL_VIEW_FLOAT32, 2 ); }
+
+/*
+ * call-seq: end_tab -> [uint32, uint32, uint32] or nil
+ */
+static VALUE
+LolSknMap_end_tab( VALUE self )
+{
+    const LolSknLayout* skn = LOL_SKN( self );
+    VALUE ary;
+    int i;
+
+    if ( skn->end_tab == NULL )
+        return Qnil;
+
+    ary = rb_ary_new2( LOL_SKN_END_TAB_SIZE );
+    for ( i = 0; i < LOL_SKN_END_TAB_SIZE; ++i )
+        rb_ary_push( ary, UINT2NUM( LolReadUInt32( skn->end_tab + 4 * i ) ) );
+
+    return ary;
+}
+
+/********************************************************************************
+ *
+ * LolModelFormat::Native::SklMap
+ *
+ ********************************************************************************/
+
+#define LOL_SKL( self ) (&LolNativeMap_get( self )->layout.skl)
+
+static int
+LolSklParse_func( void* layout, const unsigned char* data, size_t size )
+{
+    return LolSklParse( (LolSklLayout*)layout, data, size );
+}
+
+/*
+ * call-seq: SklMap.new(path)
+ *
+ * Maps a .skl file, raises FormatError unless it is a version 1 or 2 skeleton.
+ */
+static VALUE
+LolSklMap_initialize( VALUE self, VALUE path )
+{
+    return LolNativeMap_map( self, path, LolSklParse_func, "LolModelFormat::Native::SklMap" );
+}
+
+static VALUE LolSklMap_id( VALUE self ) { return rb_str_new( (const char*)LOL_SKL( self )->id, LOL_SKL_ID_SIZE ); }
+static VALUE LolSklMap_version( VALUE self ) { return UINT2NUM( LOL_SKL( self )->version ); }
+static VALUE LolSklMap_designer_id( VALUE self ) { return UINT2NUM( LOL_SKL( self )->designer_id ); }
+static VALUE LolSklMap_num_of_bones( VALUE self ) { return UINT2NUM( LOL_SKL( self )->num_of_bones ); }
+
+/*
+ * call-seq: bone_names -> [String, ...]
+ */
+static VALUE
+LolSklMap_bone_names( VALUE self )
+{
+    const LolSklLayout* skl = LOL_SKL( self );
+    VALUE ary = rb_ary_new2( skl->num_of_bones );
+    unsigned int i;
+
+    for ( i = 0; i < skl->num_of_bones; ++i )
+        rb_ary_push( ary, LolNativeName( skl->bones + (size_t)i * LOL_SKL_BONE_SIZE, LOL_SKL_BONE_NAME_SIZE ) );
+
+    return ary;
+}
+
+static VALUE
+LolSklMap_bone_view( VALUE self, size_t offset, LolViewType type, int components )
+{
+    LolView view;
+
+    LolSklBoneView( &view, LOL_SKL( self ), offset, type, components );
+
+    return LolNativeView_new( self, &view );
+}
+
+/*
+ * call-seq: parent_ids -> View of uint32, 4294967295 for root bones
+ */
+static VALUE LolSklMap_parent_ids( VALUE self ) { return LolSklMap_bone_view( self, 32, LOL_VIEW_UINT32, 1 ); }
+
+/*
+ * call-seq: scales -> View of floats
+ */
+static VALUE LolSklMap_scales( VALUE self ) { return LolSklMap_bone_view( self, 36, LOL_VIEW_FLOAT32, 1 ); }
+
+/*
+ * call-seq: matrices -> View of 12 floats per bone
+ *
+ * The 3x4 transform of each bone, row by row, as SklBone#matrix.
+ */
+static VALUE LolSklMap_matrices( VALUE self ) { return LolSklMap_bone_view( self, 40, LOL_VIEW_FLOAT32, LOL_SKL_TRANSFORM_SIZE ); }
+
+/*
+ * call-seq: num_of_bone_ids -> count or nil
+ */
+static VALUE
+LolSklMap_num_of_bone_ids( VALUE self )
+{
+    const LolSklLayout* skl = LOL_SKL( self );
+
+    return skl->bone_ids != NULL ? UINT2NUM( skl->num_of_bone_ids ) : Qnil;
+}
+
+/*
+ * call-seq: bone_ids -> View of uint32 or nil
+ *
+ * Only version 2 (and 0) skeletons have bone ids.
+ */
+static VALUE
+LolSklMap_bone_ids( VALUE self )
+{
+    const LolSklLayout* skl = LOL_SKL( self );
+    LolView view;
+
+    if ( skl->bone_ids == NULL )
+        return Qnil;
+
+    LolViewSet( &view, skl->bone_ids, skl->num_of_bone_ids, 4, LOL_VIEW_UINT32, 1 );
+
+    return LolNativeView_new( self, &view );
+}
+
+/********************************************************************************
+ *
+ * LolModelFormat::Native::AnmMap
+ *
+ ********************************************************************************/
+
+#define LOL_ANM( self ) (&LolNativeMap_get( self )->layout.anm)
+
+static int
+LolAnmParse_func( void* layout, const unsigned char* data, size_t size )
+{
+    return LolAnmParse( (LolAnmLayout*)layout, data, size );
+}
+
+/*
+ * call-seq: AnmMap.new(path)
+ *
+ * Maps a .anm file, raises FormatError unless it is a version 0 to 3 animation.
+ */
+static VALUE
+LolAnmMap_initialize( VALUE self, VALUE path )
+{
+    return LolNativeMap_map( self, path, LolAnmParse_func, "LolModelFormat::Native::AnmMap" );
+}
+
+static VALUE LolAnmMap_id( VALUE self ) { return rb_str_new( (const char*)LOL_ANM( self )->id, LOL_ANM_ID_SIZE ); }
+static VALUE LolAnmMap_version( VALUE self ) { return UINT2NUM( LOL_ANM( self )->version ); }
+static VALUE LolAnmMap_magic( VALUE self ) { return UINT2NUM( LOL_ANM( self )->magic ); }
+static VALUE LolAnmMap_number_of_bones( VALUE self ) { return UINT2NUM( LOL_ANM( self )->number_of_bones ); }
+static VALUE LolAnmMap_number_of_frames( VALUE self ) { return UINT2NUM( LOL_ANM( self )->number_of_frames ); }
+static VALUE LolAnmMap_playback_fps( VALUE self ) { return UINT2NUM( LOL_ANM( self )->playback_fps ); }
+
+/*
+ * call-seq: bone_names -> [String, ...]
+ */
+static VALUE
+LolAnmMap_bone_names( VALUE self )
+{
+    const LolAnmLayout* anm = LOL_ANM( self );
+    VALUE ary = rb_ary_new2( anm->number_of_bones );
+    unsigned int i;
+
+    for ( i = 0; i < anm->number_of_bones; ++i )
+        rb_ary_push( ary, LolNativeName( anm->bones + i * anm->bone_size, LOL_ANM_BONE_NAME_SIZE ) );
+
+    return ary;
+}
+
+/*
+ * call-seq: bone_flags -> View of uint32
+ */
+static VALUE
+LolAnmMap_bone_flags( VALUE self )
+{
+    const LolAnmLayout* anm = LOL_ANM( self );
+    LolView view;
+
+    LolViewSet( &view, anm->bones + LOL_ANM_BONE_NAME_SIZE, anm->number_of_bones, anm->bone_size, LOL_VIEW_UINT32, 1 );
+
+    return LolNativeView_new( self, &view );
+}
+
+/*
+ * call-seq: track(bone_index) -> View of 7 floats per frame
+ *
+ * The keyframes of a bone: orientation x,y,z,w followed by position x,y,z.
+ */
+static VALUE
+LolAnmMap_track( VALUE self, VALUE bone_index )
+{
+    const LolAnmLayout* anm = LOL_ANM( self );
+    long b = NUM2LONG( bone_index );
+    LolView view;
+
+    if ( b < 0 || (unsigned long)b >= anm->number_of_bones )
+        rb_raise( rb_eIndexError, "LolModelFormat::Native::AnmMap#track : bone index %ld out of range", b );
+
+    LolAnmTrackView( &view, anm, (unsigned int)b );
+
+    return LolNativeView_new( self, &view );
+}
+
+/*
+ * call-seq: poses(bind_pose = nil) -> String
+ *
+ * Packs every frame as RSkeleton poses, frame after frame. With +bind_pose+
+ * (a packed pose of the skeleton) each frame has as many bones as the
+ * skeleton and bones missing from the animation stay in bind pose.
+ */
+static VALUE
+LolAnmMap_poses( int argc, VALUE* argv, VALUE self )
+{
+    const LolAnmLayout* anm = LOL_ANM( self );
+    VALUE bind_pose, poses;
+    const float* bind = NULL;
+    long bone_count = anm->number_of_bones;
+    long frame_size = LOL_ANM_FRAME_STRIDE * (long)sizeof(float);
+
+    rb_scan_args( argc, argv, "01", &bind_pose );
+
+    if ( !NIL_P(bind_pose) )
+    {
+        StringValue( bind_pose );
+        if ( RSTRING_LEN( bind_pose ) % frame_size != 0 )
+            rb_raise( rb_eArgError, "LolModelFormat::Native::AnmMap#poses : bind pose size must be a multiple of %ld", frame_size );
+        bone_count = RSTRING_LEN( bind_pose ) / frame_size;
+        bind = (const float*)RSTRING_PTR( bind_pose );
+    }
+
+    poses = rb_str_new( NULL, bone_count * anm->number_of_frames * frame_size );
+    LolAnmGatherPoses( (float*)RSTRING_PTR( poses ), anm, bind, (unsigned int)bone_count );
+
+    RB_GC_GUARD( bind_pose );
+
+    return poses;
+}
+
+/********************************************************************************
+ *
+ * LolModelFormat::Native (MD2)
+ *
+ ********************************************************************************/
+
+/*
+ * call-seq: Native.md2_anorm_index(x, y, z) -> index or nil
+ *
+ * Index of the anorm Md2File.get_anorms_index gives for the normal,
+ * nil where it raises. A cube map narrows the search to a few anorms.
+ */
+static VALUE
+LolNative_md2_anorm_index( VALUE self, VALUE x, VALUE y, VALUE z )
+{
+    int index = LolMd2AnormIndex( NUM2DBL( x ), NUM2DBL( y ), NUM2DBL( z ) );
+
+    return index < 0 ? Qnil : INT2NUM( index );
+}
+
+typedef struct LolNativeMd2FrameArgs
+{
+    unsigned char* frame;
+    const char*    name;
+    size_t         name_len;
+    const float*   positions;
+    const float*   normals;
+    size_t         count;
+    size_t         error_index;
+    int            error;
+} LolNativeMd2FrameArgs;
+
+static void*
+LolNative_md2_frame_nogvl( void* data )
+{
+    LolNativeMd2FrameArgs* a = (LolNativeMd2FrameArgs*)data;
+
+    a->error = LolMd2QuantizeFrame( a->frame, a->name, a->name_len, a->positions, a->normals,
+                                    a->count, &a->error_index );
+
+    return NULL;
+}
+
+/* frozen Strings cannot change and are left unlocked, so threads can share them */
+static int
+LolNative_str_lock( VALUE str )
+{
+    if ( OBJ_FROZEN( str ) )
+        return 0;
+
+    rb_str_locktmp( str );
+    return 1;
+}
+
+static void
+LolNative_str_unlock( VALUE str, int locked )
+{
+    if ( locked )
+        rb_str_unlocktmp( str );
+}
+
+/*
+ * call-seq: Native.md2_frame(name, positions, normals, out = nil) -> String
+ *
+ * Quantizes the vertices of a frame, +positions+ and +normals+ packed as 'f*'
+ * (e.g. by RVec3.skinVertices), into the bytes of a Md2File::Frame record,
+ * the same ones as Md2Model#get_md2_frame. With +out+, a String, the record
+ * replaces its content. The GVL is released during the quantization.
+ */
+static VALUE
+LolNative_md2_frame( int argc, VALUE* argv, VALUE self )
+{
+    VALUE name, positions, normals, out;
+    LolNativeMd2FrameArgs args;
+    long count;
+    int locked[3];
+
+    rb_scan_args( argc, argv, "31", &name, &positions, &normals, &out );
+
+    StringValue( name );
+    StringValue( positions );
+    StringValue( normals );
+
+    if ( RSTRING_LEN( positions ) % (3 * (long)sizeof(float)) != 0 )
+        rb_raise( rb_eArgError, "LolModelFormat::Native.md2_frame : positions size must be a multiple of %ld", 3 * (long)sizeof(float) );
+    if ( RSTRING_LEN( normals ) != RSTRING_LEN( positions ) )
+        rb_raise( rb_eArgError, "LolModelFormat::Native.md2_frame : positions and normals sizes differ" );
+    count = RSTRING_LEN( positions ) / (3 * (long)sizeof(float));
+
+    if ( NIL_P(out) )
+    {
+        out = rb_str_new( NULL, (long)LolMd2FrameSize( (size_t)count ) );
+    }
+    else
+    {
+        StringValue( out );
+        rb_str_modify( out );
+        rb_str_resize( out, (long)LolMd2FrameSize( (size_t)count ) );
+        rb_enc_associate( out, rb_ascii8bit_encoding() );
+    }
+
+    args.frame = (unsigned char*)RSTRING_PTR( out );
+    args.name = RSTRING_PTR( name );
+    args.name_len = (size_t)RSTRING_LEN( name );
+    args.positions = (const float*)RSTRING_PTR( positions );
+    args.normals = (const float*)RSTRING_PTR( normals );
+    args.count = (size_t)count;
+    args.error_index = 0;
+
+    locked[0] = LolNative_str_lock( name );
+    locked[1] = LolNative_str_lock( positions );
+    locked[2] = LolNative_str_lock( normals );
+    rb_str_locktmp( out );
+    LOL_NATIVE_WITHOUT_GVL( LolNative_md2_frame_nogvl, &args );
+    rb_str_unlocktmp( out );
+    LolNative_str_unlock( normals, locked[2] );
+    LolNative_str_unlock( positions, locked[1] );
+    LolNative_str_unlock( name, locked[0] );
+
+    RB_GC_GUARD( name );
+    RB_GC_GUARD( positions );
+    RB_GC_GUARD( normals );
+
+    switch ( args.error )
+    {
+    case LOL_MD2_OK:
+        return out;
+    case LOL_MD2_NO_ANORM:
+        rb_raise( rb_eRuntimeError, "LolModelFormat::Native.md2_frame : %s of vertex %ld", LolMd2ErrorString( args.error ), (long)args.error_index );
+    case LOL_MD2_NOT_FINITE:
+        rb_raise( rb_eFloatDomainError, "LolModelFormat::Native.md2_frame : %s of vertex %ld", LolMd2ErrorString( args.error ), (long)args.error_index );
+    default:
+        rb_raise( rb_eArgError, "LolModelFormat::Native.md2_frame : %s", LolMd2ErrorString( args.error ) );
+    }
+
+    return Qnil;
+}
+
+/********************************************************************************
+ *
+ * LolModelFormat::Native::DaeWriter
+ *
+ ********************************************************************************/
+
+#define LOL_DAE_DEFAULT_CHUNK_SIZE 65536
+
+typedef struct LolNativeDaeWriter
+{
+    VALUE        io;
+    char*        buffer;
+    LolDaeWriter writer;
+} LolNativeDaeWriter;
+
+static void
+LolNativeDaeWriter_mark( void* ptr )
+{
+    LolNativeDaeWriter* w = (LolNativeDaeWriter*)ptr;
+
+    rb_gc_mark( w->io );
+}
+
+static void
+LolNativeDaeWriter_free( void* ptr )
+{
+    LolNativeDaeWriter* w = (LolNativeDaeWriter*)ptr;
+
+    xfree( w->buffer );
+    xfree( w );
+}
+
+static size_t
+LolNativeDaeWriter_memsize( const void* ptr )
+{
+    const LolNativeDaeWriter* w = (const LolNativeDaeWriter*)ptr;
+
+    return sizeof(LolNativeDaeWriter) + ( w->buffer ? w->writer.capacity : 0 );
+}
+
+static const rb_data_type_t LolNativeDaeWriter_data_type =
+{
+    "LolModelFormat::Native::DaeWriter",
+    { LolNativeDaeWriter_mark, LolNativeDaeWriter_free, LolNativeDaeWriter_memsize, },
+    0, 0, RUBY_TYPED_FREE_IMMEDIATELY
+};
+
+static VALUE
+LolNativeDaeWriter_allocate( VALUE klass )
+{
+    LolNativeDaeWriter* w = ALLOC( LolNativeDaeWriter );
+
+    memset( w, 0, sizeof(LolNativeDaeWriter) );
+    w->io = Qnil;
+
+    return TypedData_Wrap_Struct( klass, &LolNativeDaeWriter_data_type, w );
+}
+
+static LolDaeWriter*
+LolNativeDaeWriter_get( VALUE self )
+{
+    LolNativeDaeWriter* w;
+
+    TypedData_Get_Struct( self, LolNativeDaeWriter, &LolNativeDaeWriter_data_type, w );
+    if ( w->buffer == NULL )
+        rb_raise( rb_eIOError, "uninitialized DaeWriter" );
+
+    return &w->writer;
+}
+
+static void
+LolNativeDaeWriter_flush_func( void* context, const char* data, size_t length )
+{
+    rb_io_write( (VALUE)context, rb_str_new( data, (long)length ) );
+}
+
+/*
+ * call-seq: DaeWriter.new(io, chunk_size = 65536)
+ *
+ * Writes to +io+ (anything with +write+) in chunks of at most +chunk_size+ bytes.
+ */
+static VALUE
+LolNativeDaeWriter_initialize( int argc, VALUE* argv, VALUE self )
+{
+    LolNativeDaeWriter* w;
+    VALUE io, chunk_size;
+    long size = LOL_DAE_DEFAULT_CHUNK_SIZE;
+
+    rb_scan_args( argc, argv, "11", &io, &chunk_size );
+
+    if ( !NIL_P(chunk_size) )
+        size = NUM2LONG( chunk_size );
+    if ( size < LOL_DAE_NUMBER_SIZE )
+        rb_raise( rb_eArgError, "LolModelFormat::Native::DaeWriter#initialize : chunk size must be at least %d", LOL_DAE_NUMBER_SIZE );
+
+    TypedData_Get_Struct( self, LolNativeDaeWriter, &LolNativeDaeWriter_data_type, w );
+    xfree( w->buffer );
+    w->buffer = NULL;
+    w->io = io;
+    w->buffer = ALLOC_N( char, size );
+    LolDaeWriterInit( &w->writer, w->buffer, (size_t)size, LolNativeDaeWriter_flush_func, (void*)io );
+
+    return self;
+}
+
+/*
+ * call-seq: io -> io
+ */
+static VALUE
+LolNativeDaeWriter_io( VALUE self )
+{
+    LolNativeDaeWriter* w;
+
+    TypedData_Get_Struct( self, LolNativeDaeWriter, &LolNativeDaeWriter_data_type, w );
+
+    return w->io;
+}
+
+/*
+ * call-seq: flush -> self
+ *
+ * Hands the buffered bytes over to the io.
+ */
+static VALUE
+LolNativeDaeWriter_flush( VALUE self )
+{
+    LolDaeWriterFlush( LolNativeDaeWriter_get( self ) );
+
+    return self;
+}
+
+typedef struct LolNativeDaeArray
+{
+    LolDaeWriter* writer;
+    VALUE         packed;
+    size_t        count;
+    int           stride;
+    int           digits;
+    unsigned int  negate_mask;
+    int           repeat;
+    int           locked;
+} LolNativeDaeArray;
+
+static VALUE
+LolNativeDaeWriter_write_raw( VALUE data )
+{
+    LolNativeDaeArray* a = (LolNativeDaeArray*)data;
+
+    LolDaeWriteRaw( a->writer, RSTRING_PTR( a->packed ), (size_t)RSTRING_LEN( a->packed ) );
+
+    return Qnil;
+}
+
+static VALUE
+LolNativeDaeWriter_write_floats( VALUE data )
+{
+    LolNativeDaeArray* a = (LolNativeDaeArray*)data;
+
+    LolDaeWriteFloats( a->writer, (const float*)RSTRING_PTR( a->packed ), a->count, a->stride, a->digits, a->negate_mask );
+
+    return Qnil;
+}
+
+static VALUE
+LolNativeDaeWriter_write_indices( VALUE data )
+{
+    LolNativeDaeArray* a = (LolNativeDaeArray*)data;
+
+    LolDaeWriteIndices( a->writer, (const unsigned short*)RSTRING_PTR( a->packed ), a->count, a->repeat );
+
+    return Qnil;
+}
+
+static VALUE
+LolNativeDaeWriter_unlock( VALUE data )
+{
+    LolNativeDaeArray* a = (LolNativeDaeArray*)data;
+
+    LolNative_str_unlock( a->packed, a->locked );
+
+    return Qnil;
+}
+
+/* the packed String cannot change while the io may run Ruby code,
+   and is unlocked even when the io raises */
+static void
+LolNativeDaeWriter_write_locked( VALUE (*func)( VALUE ), LolNativeDaeArray* a )
+{
+    a->locked = LolNative_str_lock( a->packed );
+    rb_ensure( func, (VALUE)a, LolNativeDaeWriter_unlock, (VALUE)a );
+}
+
+/*
+ * call-seq: write(string) -> self
+ *
+ * Writes +string+ as is, e.g. the markup around the arrays.
+ */
+static VALUE
+LolNativeDaeWriter_write( VALUE self, VALUE str )
+{
+    LolNativeDaeArray a;
+
+    a.writer = LolNativeDaeWriter_get( self );
+    a.packed = rb_obj_as_string( str );
+    LolNativeDaeWriter_write_locked( LolNativeDaeWriter_write_raw, &a );
+
+    RB_GC_GUARD( a.packed );
+
+    return self;
+}
+
+/*
+ * call-seq: floats(packed, digits, stride = 1, negated = []) -> count
+ *
+ * Writes the floats of +packed+ ('f*') as the Ruby values would be by
+ * <tt>values.map { |f| f.round(digits) }.join(" ")</tt>, +digits+ within
+ * 1..9 (Float#round(0) returns Integers). Component +c+ of
+ * each +stride+ ones is written as <tt>-f.round(digits)</tt> when +negated+
+ * includes +c+.
+ */
+static VALUE
+LolNativeDaeWriter_floats( int argc, VALUE* argv, VALUE self )
+{
+    LolNativeDaeArray a;
+    VALUE packed, digits, stride, negated;
+    long i;
+
+    rb_scan_args( argc, argv, "22", &packed, &digits, &stride, &negated );
+
+    a.writer = LolNativeDaeWriter_get( self );
+    a.packed = StringValue( packed );
+    a.count = (size_t)RSTRING_LEN( packed ) / sizeof(float);
+    a.stride = NIL_P(stride) ? 1 : NUM2INT( stride );
+    a.digits = NUM2INT( digits );
+    a.negate_mask = 0;
+    a.repeat = 1;
+
+    if ( a.digits < 1 || a.digits > LOL_DAE_MAX_DIGITS )
+        rb_raise( rb_eArgError, "LolModelFormat::Native::DaeWriter#floats : digits must be within 1..%d", LOL_DAE_MAX_DIGITS );
+    if ( a.stride < 1 || a.stride > 32 )
+        rb_raise( rb_eArgError, "LolModelFormat::Native::DaeWriter#floats : stride must be within 1..32" );
+
+    if ( !NIL_P(negated) )
+    {
+        negated = rb_Array( negated );
+        for ( i = 0; i < RARRAY_LEN( negated ); ++i )
+        {
+            int c = NUM2INT( rb_ary_entry( negated, i ) );
+            if ( c < 0 || c >= a.stride )
+                rb_raise( rb_eArgError, "LolModelFormat::Native::DaeWriter#floats : negated component %d out of stride", c );
+            a.negate_mask |= 1u << c;
+        }
+    }
+
+    LolDaeBeginArray( a.writer );
+    LolNativeDaeWriter_write_locked( LolNativeDaeWriter_write_floats, &a );
+
+    return SIZET2NUM( a.count );
+}
+
+/*
+ * call-seq: indices(packed, repeat = 1) -> count
+ *
+ * Writes the uint16 of +packed+ ('S*'), each one +repeat+ times, separated by spaces.
+ */
+static VALUE
+LolNativeDaeWriter_indices( int argc, VALUE* argv, VALUE self )
+{
+    LolNativeDaeArray a;
+    VALUE packed, repeat;
+
+    rb_scan_args( argc, argv, "11", &packed, &repeat );
+
+    a.writer = LolNativeDaeWriter_get( self );
+    a.packed = StringValue( packed );
+    a.count = (size_t)RSTRING_LEN( packed ) / 2;
+    a.repeat = NIL_P(repeat) ? 1 : NUM2INT( repeat );
+
+    if ( a.repeat < 1 )
+        rb_raise( rb_eArgError, "LolModelFormat::Native::DaeWriter#indices : repeat must be positive" );
+
+    LolDaeBeginArray( a.writer );
+    LolNativeDaeWriter_write_locked( LolNativeDaeWriter_write_indices, &a );
+
+    return SIZET2NUM( a.count * (size_t)a.repeat );
+}
+
+/*
+ * call-seq: counter(count, first = 0) -> count
+ *
+ * Writes first, first + 1, ..., first + count - 1.
+ */
+static VALUE
+LolNativeDaeWriter_counter( int argc, VALUE* argv, VALUE self )
+{
+    LolDaeWriter* writer = LolNativeDaeWriter_get( self );
+    VALUE count, first;
+
+    rb_scan_args( argc, argv, "11", &count, &first );
+
+    LolDaeBeginArray( writer );
+    LolDaeWriteCounter( writer, NIL_P(first) ? 0 : NUM2SIZET( first ), NUM2SIZET( count ) );
+
+    return count;
+}
+
+/*
+ * call-seq: repeat(value, count) -> count
+ *
+ * Writes the integer +value+ +count+ times.
+ */
+static VALUE
+LolNativeDaeWriter_repeat( VALUE self, VALUE value, VALUE count )
+{
+    LolDaeWriter* writer = LolNativeDaeWriter_get( self );
+
+    LolDaeBeginArray( writer );
+    LolDaeWriteRepeated( writer, NUM2ULONG( value ), NUM2SIZET( count ) );
+
+    return count;
+}
+
+/********************************************************************************
+ *
+ * Init_LolNative
+ *
+ ********************************************************************************/
+
+LOL_NATIVE_EXPORT void
+Init_LolNative( void )
+{
+    rb_mLolModelFormat = rb_define_module( "LolModelFormat" );
+    rb_mLolNative = rb_define_module_under( rb_mLolModelFormat, "Native" );
+
+    rb_eLolFormatError = rb_define_class_under( rb_mLolNative, "FormatError", rb_eStandardError );
+
+    /************************************************************
+     * View
+     ************************************************************/
+    rb_cLolView = rb_define_class_under( rb_mLolNative, "View", rb_cObject );
+    rb_undef_alloc_func( rb_cLolView );
+    rb_include_module( rb_cLolView, rb_mEnumerable );
+
+    rb_define_method( rb_cLolView, "size", LolNativeView_size, 0 );
+    rb_define_method( rb_cLolView, "components", LolNativeView_components, 0 );
+    rb_define_method( rb_cLolView, "type", LolNativeView_type, 0 );
+    rb_define_method( rb_cLolView, "[]", LolNativeView_aref, 1 );
+    rb_define_method( rb_cLolView, "each", LolNativeView_each, 0 );
+    rb_define_method( rb_cLolView, "packed", LolNativeView_packed, 0 );
+
+    /************************************************************
+     * MappedFile
+     ************************************************************/
+    rb_cLolMappedFile = rb_define_class_under( rb_mLolNative, "MappedFile", rb_cObject );
+    rb_define_alloc_func( rb_cLolMappedFile, LolNativeMap_allocate );
+
+    rb_define_singleton_method( rb_cLolMappedFile, "open", LolNativeMap_s_open, -1 );
+    rb_define_method( rb_cLolMappedFile, "close", LolNativeMap_close, 0 );
+    rb_define_method( rb_cLolMappedFile, "closed?", LolNativeMap_closed, 0 );
+    rb_define_method( rb_cLolMappedFile, "bytesize", LolNativeMap_bytesize, 0 );
+
+    /************************************************************
+     * SknMap
+     ************************************************************/
+    rb_cLolSknMap = rb_define_class_under( rb_mLolNative, "SknMap", rb_cLolMappedFile );
+
+    rb_define_private_method( rb_cLolSknMap, "initialize", LolSknMap_initialize, 1 );
+    rb_define_method( rb_cLolSknMap, "magic", LolSknMap_magic, 0 );
+    rb_define_method( rb_cLolSknMap, "version", LolSknMap_version, 0 );
+    rb_define_method( rb_cLolSknMap, "num_of_objects", LolSknMap_num_of_objects, 0 );
+    rb_define_method( rb_cLolSknMap, "num_of_material_headers", LolSknMap_num_of_material_headers, 0 );
+    rb_define_method( rb_cLolSknMap, "material_headers", LolSknMap_material_headers, 0 );
+    rb_define_method( rb_cLolSknMap, "num_of_indices", LolSknMap_num_of_indices, 0 );
+    rb_define_method( rb_cLolSknMap, "num_of_vertices", LolSknMap_num_of_vertices, 0 );
+    rb_define_method( rb_cLolSknMap, "indices", LolSknMap_indices, 0 );
+    rb_define_method( rb_cLolSknMap, "positions", LolSknMap_positions, 0 );
+    rb_define_method( rb_cLolSknMap, "bone_indices", LolSknMap_bone_indices, 0 );
+    rb_define_method( rb_cLolSknMap, "weights", LolSknMap_weights, 0 );
+    rb_define_method( rb_cLolSknMap, "normals", LolSknMap_normals, 0 );
+    rb_define_method( rb_cLolSknMap, "tex_coords", LolSknMap_tex_coords, 0 );
+    rb_define_method( rb_cLolSknMap, "end_tab", LolSknMap_end_tab, 0 );
+
+    /************************************************************
+     * SklMap
+     ************************************************************/
+    rb_cLolSklMap = rb_define_class_under( rb_mLolNative, "SklMap", rb_cLolMappedFile );
+
+    rb_define_private_method( rb_cLolSklMap, "initialize", LolSklMap_initialize, 1 );
+    rb_define_method( rb_cLolSklMap, "id", LolSklMap_id, 0 );
+    rb_define_method( rb_cLolSklMap, "version", LolSklMap_version, 0 );
+    rb_define_method( rb_cLolSklMap, "designer_id", LolSklMap_designer_id, 0 );
+    rb_define_method( rb_cLolSklMap, "num_of_bones", LolSklMap_num_of_bones, 0 );
+    rb_define_method( rb_cLolSklMap, "bone_names", LolSklMap_bone_names, 0 );
+    rb_define_method( rb_cLolSklMap, "parent_ids", LolSklMap_parent_ids, 0 );
+    rb_define_method( rb_cLolSklMap, "scales", LolSklMap_scales, 0 );
+    rb_define_method( rb_cLolSklMap, "matrices", LolSklMap_matrices, 0 );
+    rb_define_method( rb_cLolSklMap, "num_of_bone_ids", LolSklMap_num_of_bone_ids, 0 );
+    rb_define_method( rb_cLolSklMap, "bone_ids", LolSklMap_bone_ids, 0 );
+
+    /************************************************************
+     * AnmMap
+     ************************************************************/
+    rb_cLolAnmMap = rb_define_class_under( rb_mLolNative, "AnmMap", rb_cLolMappedFile );
+
+    rb_define_const( rb_cLolAnmMap, "FRAME_STRIDE", INT2NUM(LOL_ANM_FRAME_STRIDE) );
+
+    rb_define_private_method( rb_cLolAnmMap, "initialize", LolAnmMap_initialize, 1 );
+    rb_define_method( rb_cLolAnmMap, "id", LolAnmMap_id, 0 );
+    rb_define_method( rb_cLolAnmMap, "version", LolAnmMap_version, 0 );
+    rb_define_method( rb_cLolAnmMap, "magic", LolAnmMap_magic, 0 );
+    rb_define_method( rb_cLolAnmMap, "number_of_bones", LolAnmMap_number_of_bones, 0 );
+    rb_define_method( rb_cLolAnmMap, "number_of_frames", LolAnmMap_number_of_frames, 0 );
+    rb_define_method( rb_cLolAnmMap, "playback_fps", LolAnmMap_playback_fps, 0 );
+    rb_define_method( rb_cLolAnmMap, "bone_names", LolAnmMap_bone_names, 0 );
+    rb_define_method( rb_cLolAnmMap, "bone_flags", LolAnmMap_bone_flags, 0 );
+    rb_define_method( rb_cLolAnmMap, "track", LolAnmMap_track, 1 );
+    rb_define_method( rb_cLolAnmMap, "poses", LolAnmMap_poses, -1 );
+
+    /************************************************************
+     * MD2
+     ************************************************************/
+    LolMd2AnormTableInit();
+
+    rb_define_const( rb_mLolNative, "MD2_FRAME_HEADER_SIZE", INT2NUM(LOL_MD2_FRAME_HEADER_SIZE) );
+    rb_define_const( rb_mLolNative, "MD2_VERTEX_SIZE", INT2NUM(LOL_MD2_VERTEX_SIZE) );
+
+    rb_define_module_function( rb_mLolNative, "md2_anorm_index", LolNative_md2_anorm_index, 3 );
+    rb_define_module_function( rb_mLolNative, "md2_frame", LolNative_md2_frame, -1 );
+
+    /************************************************************
+     * DaeWriter
+     ************************************************************/
+    rb_cLolDaeWriter = rb_define_class_under( rb_mLolNative, "DaeWriter", rb_cObject );
+    rb_define_alloc_func( rb_cLolDaeWriter, LolNativeDaeWriter_allocate );
+
+    rb_define_private_method( rb_cLolDaeWriter, "initialize", LolNativeDaeWriter_initialize, -1 );
+    rb_define_method( rb_cLolDaeWriter, "io", LolNativeDaeWriter_io, 0 );
+    rb_define_method( rb_cLolDaeWriter, "write", LolNativeDaeWriter_write, 1 );
+    rb_define_method( rb_cLolDaeWriter, "<<", LolNativeDaeWriter_write, 1 );
+    rb_define_method( rb_cLolDaeWriter, "flush", LolNativeDaeWriter_flush, 0 );
+    rb_define_method( rb_cLolDaeWriter, "floats", LolNativeDaeWriter_floats, -1 );
+    rb_define_method( rb_cLolDaeWriter, "indices", LolNativeDaeWriter_indices, -1 );
+    rb_define_method( rb_cLolDaeWriter, "counter", LolNativeDaeWriter_counter, -1 );
+    rb_define_method( rb_cLolDaeWriter, "repeat", LolNativeDaeWriter_repeat, 2 );
+}
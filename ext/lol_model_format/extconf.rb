@@ -0,0 +1,14 @@
+require 'mkmf'
+
+# Files are mapped with mmap where available, read into memory otherwise.
+have_header('sys/mman.h')
+have_func('mmap', 'sys/mman.h')
+
+# The MD2 quantizer releases the GVL when available.
+have_header('ruby/thread.h')
+have_func('rb_thread_call_without_gvl', 'ruby/thread.h')
+
+# The MD2 quantizer must round as Ruby does, without fused multiply-adds.
+$CFLAGS << ' -ffp-contract=off' if try_cflags('-ffp-contract=off')
+
+create_makefile('LolNative')
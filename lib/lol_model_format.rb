@@ -1,10 +1,12 @@
 require 'bindata' # http://bindata.rubyforge.org/
+require 'lol_model_format/native'
 #require 'lol_model_format/skl_file'
 #require 'lol_model_format/skn_file'
 #require 'lol_model_format/anm_file'
 require 'lol_model_format/lol_model'
 require 'lol_model_format/md2/md2_model'
 require 'lol_model_format/dae/dae_model'
+require 'lol_model_format/batch_converter'
 
 module LolModelFormat
     VERSION = "0.0.1"
@@ -24,8 +24,13 @@ module LolModelFormat
     end
 end
 
+# RMATH_PRECISION=single loads the float build, RMATH_SIMD=scalar|sse2|avx2 picks its kernels.
 begin
-	require File.expand_path('../../../vendor/ruby-math-3d/RMath.so', __FILE__)
+	if ENV['RMATH_PRECISION'] == 'single'
+		require File.expand_path('../../../vendor/ruby-math-3d/single/RMath.so', __FILE__)
+	else
+		require File.expand_path('../../../vendor/ruby-math-3d/RMath.so', __FILE__)
+	end
 rescue LoadError
 	puts "RMath.so does not exist. Require plain version."
 	require File.expand_path('../../../vendor/ruby-math-3d/RMath.rb', __FILE__)
@@ -33,6 +38,8 @@ end
 
 #require File.expand_path('../../../vendor/ruby-math-3d/RMath.rb', __FILE__)
 
+RMath.setSIMDLevel(ENV['RMATH_SIMD'].to_sym) unless ENV['RMATH_SIMD'].to_s.empty?
+
 include RMath
 
 
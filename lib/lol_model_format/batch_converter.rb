@@ -0,0 +1,208 @@
+require 'etc'
+require 'fileutils'
+require 'lol_model_format/pipeline'
+
+module LolModelFormat
+
+    # Converts many models at once to MD2 (and DAE) as a Pipeline of stages,
+    # each one run by as many threads as there are cores by default:
+    #
+    # * parse : reads the files of a model (mapped with LolNative) and passes
+    #   on its static frame and each of its animations
+    # * pose : RSkeleton#evaluate of the poses of each frame
+    # * skin : RVec3.skinVertices with each palette
+    # * quantize : Md2Model#get_md2_frame_from_buffers (Native.md2_frame)
+    # * write : the files of a model, once all its frames are quantized
+    #
+    # Animations of a model are converted in parallel, as are the models.
+    #
+    #   converter = BatchConverter.new('generated', :formats => [:md2, :dae])
+    #   converter.convert(BatchConverter.assets_in('spec/fixture'))
+    #   puts converter.report
+    class BatchConverter
+
+        # files of a model, +animations+ maps animation names to .anm files
+        Asset = Struct.new(:name, :skl, :skn, :animations)
+
+        attr_reader :output_dir, :workers, :queue_size, :formats, :stats
+
+        # models of +dir+ laid out as spec/fixture : NAME/NAME.skl,
+        # NAME/NAME.skn and NAME/NAME_ANIMATION.anm
+        def self.assets_in(dir)
+            Dir[File.join(dir, '*')].sort.map do |model_dir|
+                name = File.basename(model_dir)
+                skl = File.join(model_dir, "#{name}.skl")
+                skn = File.join(model_dir, "#{name}.skn")
+                next unless File.file?(skl) && File.file?(skn)
+
+                animations = {}
+                Dir[File.join(model_dir, "#{name}_*.anm")].sort.each do |anm|
+                    animations[File.basename(anm, '.anm')[name.size + 1..-1]] = anm
+                end
+
+                Asset.new(name, skl, skn, animations)
+            end.compact
+        end
+
+        # options :
+        # * :workers - threads of each stage, the number of cores by default
+        # * :queue_size - items waiting between two stages, 2 * workers by default
+        # * :formats - [:md2] by default, :dae needs the BinData skl records
+        def initialize(output_dir, options = {})
+            @output_dir = output_dir
+            @workers = options[:workers] || Etc.nprocessors
+            @queue_size = options[:queue_size] || 2 * @workers
+            @formats = options[:formats] || [:md2]
+            @stats = []
+        end
+
+        # converts +assets+, returns the files written
+        def convert(assets)
+            FileUtils.mkdir_p @output_dir
+
+            written = []
+            written_mutex = Mutex.new
+
+            pipeline = Pipeline.new(@queue_size)
+            pipeline.stage('parse', @workers, 'files') { |asset, emit| parse(asset, emit) }
+            pipeline.stage('pose', @workers, 'frames') { |job, emit| pose(job, emit) }
+            pipeline.stage('skin', @workers, 'frames') { |job, emit| skin(job, emit) }
+            pipeline.stage('quantize', @workers, 'frames') { |job, emit| quantize(job, emit) }
+            pipeline.stage('write', @workers, 'frames') do |job, emit|
+                files = write(job)
+                written_mutex.synchronize { written.concat files }
+                job.frames.size
+            end
+
+            begin
+                pipeline.run(assets)
+            ensure
+                @stats = pipeline.report
+            end
+
+            written
+        end
+
+        # throughput of each stage of the last conversion, one line per stage
+        def report
+            @stats.map do |s|
+                "%-8s %3d workers %6d items %8d %-6s %9.3fs wall %9.3fs busy %9.3fs stalled %12.1f %s/s" %
+                    [s[:stage], s[:workers], s[:items], s[:units], s[:unit],
+                     s[:wall], s[:busy], s[:stalled], s[:units_per_second], s[:unit]]
+            end.join("\n")
+        end
+
+        private
+
+        # a model being converted, +frames+ gets the frames of each job
+        ModelContext = Struct.new(:asset, :lol_model, :md2_model, :packed, :frames, :pending, :mutex)
+
+        # the static frame (index 0, no +anm+) or an animation of a model
+        Job = Struct.new(:model, :index, :name, :anm, :palettes, :buffers, :frames)
+
+        def parse(asset, emit)
+            native = LolModelFormat.native?
+
+            # DaeModel builds the bone tree from the BinData skl records
+            skl = if native && !@formats.include?(:dae)
+                Native::SklMap.new(asset.skl)
+            else
+                File.open(asset.skl, 'rb') { |io| SklFile.read(io) }
+            end
+
+            skn = native ? Native::SknMap.new(asset.skn) : File.open(asset.skn, 'rb') { |io| SknFile.read(io) }
+
+            anms = {}
+            asset.animations.each do |name, file|
+                anms[name] = native ? Native::AnmMap.new(file) : File.open(file, 'rb') { |io| AnmFile.read(io) }
+            end
+
+            lol_model = LolModel.new(skl, skn, anms)
+            # memoized, built before the pose workers share it
+            lol_model.native_skeleton
+
+            packed = lol_model.pack_vertices(native ? skn : skn.vertices)
+            model = ModelContext.new(asset, lol_model, Md2::Md2Model.new(lol_model), packed,
+                                     Array.new(anms.size + 1), anms.size + 1, Mutex.new)
+
+            emit.call Job.new(model, 0, 'static001', nil)
+            anms.each_with_index do |(name, anm), i|
+                emit.call Job.new(model, i + 1, name, anm)
+            end
+
+            2 + anms.size
+        end
+
+        def pose(job, emit)
+            unless job.anm.nil?
+                job.palettes = job.model.lol_model.native_skeleton.evaluate(job.model.lol_model.get_anm_poses(job.anm))
+            end
+
+            emit.call job
+            job.palettes ? job.palettes.size : 1
+        end
+
+        def skin(job, emit)
+            packed = job.model.packed
+
+            job.buffers = if job.palettes.nil?
+                [[packed.positions, packed.normals]]
+            else
+                job.palettes.map do |palette|
+                    RVec3.skinVertices(packed.positions, packed.normals, packed.bone_indices, packed.weights, palette)
+                end
+            end
+            job.palettes = nil
+
+            emit.call job
+            job.buffers.size
+        end
+
+        def quantize(job, emit)
+            md2_model = job.model.md2_model
+
+            job.frames = job.buffers.each_with_index.map do |(positions, normals), i|
+                name = job.anm.nil? ? job.name : md2_model.md2_frame_name(job.name, i)
+                md2_model.get_md2_frame_from_buffers(name, positions, normals)
+            end
+            job.buffers = nil
+
+            emit.call job
+            job.frames.size
+        end
+
+        # writes the files of the model once its last job is in
+        def write(job)
+            model = job.model
+
+            done = model.mutex.synchronize do
+                model.frames[job.index] = job.frames
+                (model.pending -= 1) == 0
+            end
+            return [] unless done
+
+            files = []
+
+            if @formats.include? :md2
+                files << File.join(@output_dir, "#{model.asset.name}.md2")
+                File.open(files.last, 'wb') { |io| model.md2_model.write_md2_from_frames(io, model.frames.flatten(1)) }
+            end
+
+            if @formats.include? :dae
+                files << File.join(@output_dir, "#{model.asset.name}.dae")
+                File.open(files.last, 'wb') { |io| Dae::DaeModel.new(model.lol_model).write_dae(io, model.asset.name) }
+            end
+
+            model.frames = nil
+            close(model.lol_model)
+
+            files
+        end
+
+        def close(lol_model)
+            [lol_model.skeleton_file, lol_model.skin_file, *lol_model.animation_files.values].each do |file|
+                file.close if file.respond_to? :close
+            end
+        end
+    end
+end
@@ -1,3 +1,5 @@
+require 'stringio'
+
 module LolModelFormat
     module Dae
         class DaeModel
@@ -6,10 +8,100 @@ module LolModelFormat
                 @lol_model = lol_model
             end
 
+            # marks where write_dae streams a vertex array into the rendered template
+            ARRAY_PLACEHOLDER = /LOLDAEARRAY_([a-z-]+)_LOLDAEARRAY/
+
             #COLLADA 
             def to_dae(model_name = nil)
+                return render_dae(model_name) unless LolModelFormat.native?
+
+                write_dae(StringIO.new, model_name).string
+            end
+
+            # Writes the same document as to_dae into +io+. With LolNative, the
+            # vertex arrays are written from packed buffers in bounded chunks and
+            # the template only renders the markup around them.
+            def write_dae(io, model_name = nil)
+                unless LolModelFormat.native?
+                    io.write render_dae(model_name)
+                    return io
+                end
+
                 @model = {}
+                arrays = gen_packed_vertex_arrays
+
+                writer = Native::DaeWriter.new(io)
+                render(model_name).split(ARRAY_PLACEHOLDER).each_with_index do |part, i|
+                    if i.odd?
+                        arrays[part].call(writer)
+                    else
+                        writer.write part
+                    end
+                end
+                writer.flush
+
+                io
+            end
+
+            private
+
+            # the plain version of write_dae
+            def render_dae(model_name)
+                @model = {}
+                gen_vertex_arrays
+                render(model_name)
+            end
 
+            # writers of the vertex arrays, the template gets placeholders
+            def gen_packed_vertex_arrays
+                skin = @lol_model.skin_file
+
+                if skin.respond_to? :positions
+                    count = skin.num_of_vertices
+                    positions, normals = skin.positions.packed, skin.normals.packed
+                    tex_coords, weights = skin.tex_coords.packed, skin.weights.packed
+                    indices = skin.indices.packed
+                else
+                    count = skin.vertices.size
+                    positions, normals, tex_coords, weights = [], [], [], []
+
+                    skin.vertices.each do |v|
+                        positions.push v.position.x.to_f, v.position.y.to_f, v.position.z.to_f
+                        normals.push v.normal.x.to_f, v.normal.y.to_f, v.normal.z.to_f
+                        tex_coords.push v.tex_coords.x.to_f, v.tex_coords.y.to_f
+                        v.weights.each { |weight| weights << weight.to_f }
+                    end
+
+                    positions, normals = positions.pack('f*'), normals.pack('f*')
+                    tex_coords, weights = tex_coords.pack('f*'), weights.pack('f*')
+                    indices = skin.indices.to_a.pack('S*')
+                end
+
+                index_count = indices.bytesize / 2
+
+                @model["positions-array-size"] = 3 * count
+                @model["normals-array-size"] = 3 * count
+                @model["map-array-size"] = 2 * count
+                @model["triangles-array-size"] = index_count / 3
+                @model["weights-array-size"] = weights.bytesize / 4
+                @model["vertex-weights-count"] = count
+
+                arrays = {
+                    "positions-array" => lambda { |w| w.floats positions, 4, 3 },
+                    "normals-array" => lambda { |w| w.floats normals, 6, 3 },
+                    "map-array" => lambda { |w| w.floats tex_coords, 6, 2, [1] },
+                    "triangles-array" => lambda { |w| w.indices indices, 3 },
+                    "weights-array" => lambda { |w| w.floats weights, 6 },
+                    "vcount-array" => lambda { |w| w.repeat 4, count },
+                    "v-array" => lambda { |w| w.counter 4 * count }
+                }
+
+                arrays.each_key { |name| @model[name] = "LOLDAEARRAY_#{name}_LOLDAEARRAY" }
+
+                arrays
+            end
+
+            def gen_vertex_arrays
                 positions = []
                 normals = []
                 tex_coords = []
@@ -62,7 +154,6 @@ module LolModelFormat
                 #computedLen = ((triangleData.length) / cl_inputmap.length) / 3;
                 # cl_inputmap: [VERTEX NORMAL TEXCOORD].size == 3
                 @model["triangles-array-size"] = triangles.size / 9
-                @model["texture-file-name"] = "#{model_name || 'texture'}.jpg" 
 
                 @model["weights-array-size"] = weights.size
                 @model["weights-array"] = weights.join ' '
@@ -71,11 +162,13 @@ module LolModelFormat
                 @model["v-array"] = v_array.join " "
 
                 @model["vertex-weights-count"] = @lol_model.skin_file.vertices.size
+            end
 
-                bone_trees, name_arrays = @lol_model.gen_bone_tree_from_skl
+            # renders the template once the vertex arrays are in @model
+            def render(model_name)
+                @model["texture-file-name"] = "#{model_name || 'texture'}.jpg" 
 
-                puts JSON.pretty_generate(bone_trees)
-                puts JSON.pretty_generate(name_arrays)
+                bone_trees, name_arrays = @lol_model.gen_bone_tree_from_skl
 
                 @model["bone-tree"] = bone_trees
                 @model["skeleton-names"] = name_arrays["root"]            
@@ -178,7 +178,7 @@ module LolModelFormat
                 
                 
                 local_transform = RMtx4.new.rotationQuaternion(@orientation)      
-                local_transform *= RMtx4.new.translation(@position.x, @position.y, @position.z)
+                local_transform.mul!(RMtx4.new.translation(@position.x, @position.y, @position.z))
                   
                 #local_transform *= RMtx4.new.scaling(scale, scale, scale) 
                 
@@ -195,7 +195,7 @@ module LolModelFormat
                     
                     # Append matrices for position transform A * B
                     # Append quaternions for rotation transform B * A
-                    @transform = local_transform * parent.transform
+                    @transform = local_transform.mul!(parent.transform)
                     @reverse_transform = @transform.getInverse
                     @orientation = parent.orientation * @orientation
                 end
@@ -297,8 +297,6 @@ module LolModelFormat
 
             skeleton.bones.each { |i, bone| root_bone_index << bone.index if bone.root? }
 
-            puts root_bone_index
-
             raise "root bone not found!" if root_bone_index.size == 0
             #raise "more than one root bone!" if root_bone_index.size > 1 
             name_arrays = {}
@@ -340,7 +338,7 @@ module LolModelFormat
                 else
                     bone_index = bone_index_orig
                     #puts @skeleton_file.bone_ids
-                    puts "ALERT: remap_bone_index #{bone_index_orig} >= #{@skeleton_file.bone_ids.size}"
+                    warn "ALERT: remap_bone_index #{bone_index_orig} >= #{@skeleton_file.bone_ids.size}"
                 end	 
             else
                 bone_index = bone_index_orig
@@ -349,77 +347,163 @@ module LolModelFormat
             bone_index.to_i
         end
 
+        # Vertex attributes packed for RVec3.skinVertices,
+        # bone indices are already remapped to skl bone indices
+        PackedVertices = Struct.new(:positions, :normals, :bone_indices, :weights, :count)
+
+        # +vertices+ are SknFile::SknVertex records or a Native::SknMap,
+        # the buffers are frozen so that threads can skin them at once.
+        # Raises ArgumentError when a remapped bone index does not fit in a byte.
+        def pack_vertices(vertices)
+            remapped = Hash.new do |h, bi|
+                bone_index = remap_bone_index(bi)
+                raise ArgumentError, "bone index #{bi} remapped to #{bone_index}, out of 0..255" unless (0..255).include? bone_index
+                h[bi] = bone_index
+            end
+
+            if vertices.respond_to? :positions
+                bone_indices = vertices.bone_indices.packed.unpack('C*').map { |bi| remapped[bi] }
+
+                return PackedVertices.new(vertices.positions.packed.freeze, vertices.normals.packed.freeze,
+                                          bone_indices.pack('C*').freeze, vertices.weights.packed.freeze,
+                                          vertices.num_of_vertices)
+            end
+
+            positions = []
+            normals = []
+            bone_indices = []
+            weights = []
+
+            vertices.each do |v|
+                positions.push v.position.x.to_f, v.position.y.to_f, v.position.z.to_f
+                normals.push v.normal.x.to_f, v.normal.y.to_f, v.normal.z.to_f
+                v.bone_index.each { |bi| bone_indices << remapped[bi.to_i] }
+                v.weights.each { |w| weights << w.to_f }
+            end
+
+            PackedVertices.new(positions.pack('f*').freeze, normals.pack('f*').freeze,
+                               bone_indices.pack('C*').freeze, weights.pack('f*').freeze, vertices.size)
+        end
+
+        # RSkeleton built from the skl bones, bones are evaluated in a single
+        # parents-first pass and the inverse bind matrices are computed once
+        def native_skeleton
+            @native_skeleton ||= gen_native_skeleton_from_skl
+        end
+
+        def gen_native_skeleton_from_skl
+            parent_ids = if @skeleton_file.respond_to? :parent_ids
+                @skeleton_file.parent_ids.to_a
+            else
+                @skeleton_file.bones.map { |bone| bone.parent_id.to_i }
+            end
+
+            RSkeleton.new parent_ids, get_bind_pose.flatten.pack('f*')
+        end
+
+        # local orientation and position of each skl bone, laid out as RSkeleton poses
+        def get_bind_pose
+            if @skeleton_file.respond_to? :matrices
+                orientations_and_positions = @skeleton_file.matrices.map do |matrix|
+                    [SklFile::SklBone.orientation_from_matrix(matrix), SklFile::SklBone.position_from_matrix(matrix)]
+                end
+            else
+                orientations_and_positions = @skeleton_file.bones.map { |bone| [bone.orientation, bone.position] }
+            end
+
+            orientations_and_positions.map do |o, p|
+                [o.x, o.y, o.z, o.w, p.x, p.y, p.z]
+            end
+        end
+
+        # packed RSkeleton poses of all frames of the animation,
+        # skl bones missing from the animation stay in bind pose
+        def get_anm_poses(anm_file)
+            bind_pose = get_bind_pose
+
+            return anm_file.poses(bind_pose.flatten.pack('f*')) if anm_file.respond_to? :poses
+
+            anm_bones = anm_file.bones.to_a.first(bind_pose.size)
+            poses = []
+
+            0.upto anm_file.number_of_frames - 1 do |frame_index|
+                bind_pose.each_with_index do |bind, i|
+                    if i < anm_bones.size
+                        frame = anm_bones[i].frames[frame_index]
+                        o = frame.orientation_origin
+                        p = frame.position_origin
+                        poses.push o.x.value, o.y.value, o.z.value, o.w.value, p.x.value, p.y.value, p.z.value
+                    else
+                        poses.concat bind
+                    end
+                end
+            end
+
+            poses.pack('f*')
+        end
+
+        # packed RSkeleton poses of the animation retimed from its playback_fps
+        # to +fps+ : one pose every 1 / +fps+ seconds over the same duration
+        def get_anm_poses_at_fps(anm_file, fps)
+            playback_fps = anm_file.playback_fps.to_f
+            raise ArgumentError, "animation has no playback fps" unless playback_fps > 0.0
+
+            duration = (anm_file.number_of_frames.to_i - 1) / playback_fps
+            count = (duration * fps.to_f + 1.0e-6).floor + 1
+
+            native_skeleton.samplePoses(get_anm_poses(anm_file), playback_fps,
+                                        0.0, (count - 1) / fps.to_f, count)
+        end
+
+        # skinned [positions, normals] of each frame, packed as 'f*',
+        # the animation is resampled at +fps+ when given
+        def get_animated_vertex_buffers(vertices, anm_file, fps = nil)
+            packed = pack_vertices(vertices)
+            poses = fps ? get_anm_poses_at_fps(anm_file, fps) : get_anm_poses(anm_file)
+
+            native_skeleton.evaluate(poses).map do |palette|
+                RVec3.skinVertices(packed.positions, packed.normals,
+                                   packed.bone_indices, packed.weights, palette)
+            end
+        end
+
         def get_animated_vertice_frames(vertices, anm_file)
             vertice_frames = []
-            
-            #0.upto anm_file.number_of_frames - 1 do |frame_index|
-            0.upto 5 do |frame_index|
-                puts frame_index
-                
-                frame_vertices =[]
-                
-                skeleton = get_skl_from_anm_frame(anm_file, frame_index)
-                
-                vertices.each do |v|
+
+            get_animated_vertex_buffers(vertices, anm_file).each do |positions, normals|
+                positions = positions.unpack('f*')
+                normals = normals.unpack('f*')
+
+                frame_vertices = []
+
+                vertices.each_with_index do |v, i|
                     vertex = SknFile::SknVertex.new
-                    
-                    #// Transform the vertex information based on bones.
-                    position = RVec3.new
-                    normal = RVec3.new
-                    total_weight = 0.0
-                    
-                    0.upto 3 do |i|
-                        bone_index = remap_bone_index(v.bone_index[i])
-                        
-                        static_bone = static_skeleton.bones[bone_index]
-                        
-                        scale = static_bone.scale.value
-                        
-                        bone_transformer =  static_bone.reverse_transform
-                        bone_transformer *= skeleton.bones[bone_index].transform
-                        
-                         #static_skeleton.bones[bone_index].reverse_transform * 
-                        
-                        
-                        #bone_transformer = RMtx4.new.rotationY(0.314 * frame_index)
-                        
-                        v_postion = RVec3.new(v.position.x.value, v.position.y.value, v.position.z.value).transformCoord(bone_transformer)
-                        
-                        position += v.weights[i] * v_postion
-                        
-                        v_normal = RVec3.new(v.normal.x.value, v.normal.y.value, v.normal.z.value).transformNormal(bone_transformer)
-                        
-                        normal += v.weights[i] * v_normal
-                        
-                        total_weight += v.weights[i]
-                    end
-                    
-                    vertex.position.x = position.x / total_weight
-                    vertex.position.y = position.y / total_weight
-                    vertex.position.z = position.z / total_weight
-                    
-                    vertex.normal.x = normal.x / total_weight
-                    vertex.normal.y = normal.y / total_weight
-                    vertex.normal.z = normal.z / total_weight
-                    
+
+                    vertex.position.x = positions[3 * i]
+                    vertex.position.y = positions[3 * i + 1]
+                    vertex.position.z = positions[3 * i + 2]
+
+                    vertex.normal.x = normals[3 * i]
+                    vertex.normal.y = normals[3 * i + 1]
+                    vertex.normal.z = normals[3 * i + 2]
+
                     v.bone_index.each do |bi|
                         vertex.bone_index << bi
                     end
-                    
+
                     v.weights.each do |w|
                         vertex.weights << w
                     end
-                    
+
                     vertex.tex_coords.x = v.tex_coords.x
                     vertex.tex_coords.y = v.tex_coords.y
-                                   
-                    frame_vertices << vertex
 
+                    frame_vertices << vertex
                 end
-            
+
                 vertice_frames << frame_vertices
             end
-            
+
             vertice_frames
         end
     end
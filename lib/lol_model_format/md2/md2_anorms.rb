@@ -172,7 +172,7 @@ module LolModelFormat
 			]
 			
 			def self.get_anorms_index(normal_x, normal_y, normal_z)
-				#TODO three cycles, need to optimize
+				#plain version of Native.md2_anorm_index (full scan of Anorms)
 				
 				best_normal = Anorms.find_all do |n|
 					#same sign
@@ -28,8 +28,6 @@ module LolModelFormat
                 static_skeleton = @lol_model.static_skeleton
                 
                 #trianle that determines how all vertexes form faces TODO
-                puts static_skeleton.bones.size
-                
                 #TODO 
                 static_vertices = @lol_model.get_vertices_from_skl(static_skeleton, offset)
                 md2.triangles = get_md2_skl_trianles(static_vertices.size / 3)
@@ -42,7 +40,6 @@ module LolModelFormat
                         
                         0.upto anm_file.number_of_frames - 1 do |frame_index|
                         #1.upto 2 do |frame_index|
-                            puts frame_index    
                                             
                                 formated_frame_name = "skl_%s%03d" % [escape_md2_frame_name(name), frame_index + 1] 
                                 
@@ -53,9 +50,8 @@ module LolModelFormat
                     end             
                 else            
                     @lol_model.animation_files.each do |name, anm_file|
-                        @lol_model.get_animated_vertice_frames(static_vertices, anm_file).each_with_index do |frame_vertices, i|
-                            formated_frame_name = "skl_%s%03d" % [escape_md2_frame_name(name), i + 1]
-                            md2.frames << get_md2_frame(formated_frame_name, frame_vertices)
+                        get_md2_frames("skl_#{escape_md2_frame_name(name)}", static_vertices, anm_file).each do |frame|
+                            md2.frames << frame
                         end
                     end
                 end
@@ -64,6 +60,112 @@ module LolModelFormat
             end
 
             def to_md2
+                # a Native::SknMap packs its vertices itself
+                skin = @lol_model.skin_file
+                vertices = skin.respond_to?(:positions) ? skin : skin.vertices
+                packed = @lol_model.pack_vertices(vertices)
+
+                #add a frame to describe the static model
+                frames = [get_md2_frame_from_buffers('static001', packed.positions, packed.normals)]
+
+                @lol_model.animation_files.each do |name, anm_file|
+                    @lol_model.get_animated_vertex_buffers(vertices, anm_file).each_with_index do |(positions, normals), i|
+                        frames << get_md2_frame_from_buffers(md2_frame_name(name, i), positions, normals)
+                    end
+                end
+
+                to_md2_from_frames(frames)
+            end
+
+            # same as to_md2 with frames made elsewhere (e.g. by BatchConverter),
+            # 'static001' first, then the frames of each animation in order,
+            # packed as returned by get_md2_frame_from_buffers
+            def to_md2_from_frames(frames)
+                md2 = new_md2
+
+                frames.each do |frame|
+                    md2.frames << read_md2_frame(frame)
+                end
+
+                md2
+            end
+
+            # writes to_md2_from_frames(frames) to +io+, the packed frames are
+            # copied as they are instead of being read into BinData records
+            def write_md2_from_frames(io, frames)
+                return to_md2_from_frames(frames).write(io) if frames.empty?
+
+                # the file with the first frame only, then all the frames in its place
+                md2 = new_md2
+                md2.frames << read_md2_frame(frames.first)
+                single = md2.to_binary_s
+
+                frame_size = frames.first.bytesize
+                num_frames, offset_frames, offset_glcmds, offset_end = single.unpack('@40l<@56l<3')
+                unless num_frames == 1 && single[offset_frames, frame_size] == frames.first
+                    return to_md2_from_frames(frames).write(io)
+                end
+
+                grown = frame_size * (frames.size - 1)
+                header = single[0, offset_frames]
+                header[40, 4] = [frames.size].pack('l<')
+                header[60, 8] = [offset_glcmds + grown, offset_end + grown].pack('l<2')
+
+                io.write header
+                frames.each { |frame| io.write frame }
+                io.write single[offset_frames + frame_size..-1]
+            end
+
+            # name of the +index+-th frame of an animation in to_md2
+            def md2_frame_name(animation_name, index)
+                "%s%03d" % [escape_md2_frame_name(animation_name), index + 1]
+            end
+
+            # same frame as get_md2_frame, from positions and normals packed as 'f*',
+            # packed as well (String of the record) ; Native.md2_frame quantizes it
+            # when LolNative is built
+            def get_md2_frame_from_buffers(frame_name, positions, normals)
+                return Native.md2_frame(frame_name, positions, normals) if LolModelFormat.native?
+
+                positions = positions.unpack('f*')
+                normals = normals.unpack('f*')
+
+                vertices = Array.new(positions.size / 3) do |i|
+                    BufferVertex.new(RVec3.new(*positions[3 * i, 3]), RVec3.new(*normals[3 * i, 3]))
+                end
+
+                get_md2_frame(frame_name, vertices).to_binary_s
+            end
+
+            private
+
+            # vertex of get_md2_frame read from packed buffers
+            BufferVertex = Struct.new(:position, :normal)
+
+            # sizes of a packed frame : scale, translate and name, then v[3]
+            # and normal_index of each vertex
+            PACKED_FRAME_HEADER_SIZE = 40
+            PACKED_VERTEX_SIZE = 4
+
+            # Md2File::Frame of a packed frame
+            def read_md2_frame(data)
+                frame = Md2File::Frame.new
+                frame.scale.x, frame.scale.y, frame.scale.z,
+                    frame.translate.x, frame.translate.y, frame.translate.z = data.unpack('e6')
+                frame.name = data.unpack('@24Z16').first
+
+                data.unpack("@#{PACKED_FRAME_HEADER_SIZE}C*").each_slice(PACKED_VERTEX_SIZE) do |x, y, z, normal_index|
+                    vertex = Md2File::Vertex.new
+                    vertex.v = [x, y, z]
+                    vertex.normal_index = normal_index
+                    frame.verts << vertex
+                end
+
+                frame
+            end
+
+            # header, skin coords and triangles of the model, without frames
+            def new_md2
                 md2 = Md2File.new
                 
                 #TODO make skin size configurable
@@ -80,29 +182,24 @@ module LolModelFormat
                 
                 #trianle that determines how all vertexes form faces
                 md2.triangles = get_md2_trianles
-                
-                #add a frame to describe the static model
-                md2.frames << get_md2_frame('static001', @lol_model.skin_file.vertices)
-
-                @lol_model.animation_files.each do |name, anm_file|
-                    @lol_model.get_animated_vertice_frames(@lol_model.skin_file.vertices, anm_file).each_with_index do |frame_vertices, i|
-                        formated_frame_name = "%s%03d" % [escape_md2_frame_name(name), i + 1]
-                        md2.frames << get_md2_frame(formated_frame_name, frame_vertices)
-                    end
-                end
 
                 md2
             end
 
-            private
-
             def get_md2_skin_coords(skinwidth, skinheight)
                 skin_coords = []
                 
-                @lol_model.skin_file.vertices.each do |v|
+                # a Native::SknMap has no vertex records
+                tex_coords = if @lol_model.skin_file.respond_to? :tex_coords
+                    @lol_model.skin_file.tex_coords.to_a
+                else
+                    @lol_model.skin_file.vertices.map { |v| [v.tex_coords.x, v.tex_coords.y] }
+                end
+
+                tex_coords.each do |x, y|
                     coord = Md2File::SkinCoord.new
-                    coord.s = (skinwidth * v.tex_coords.x).to_i
-                    coord.t = (skinheight * v.tex_coords.y).to_i
+                    coord.s = (skinwidth * x).to_i
+                    coord.t = (skinheight * y).to_i
                     skin_coords << coord
                 end
                 
@@ -114,10 +211,10 @@ module LolModelFormat
                 
                 0.upto (@lol_model.skin_file.indices.size / 3) do |i|
                     
-                    #three vertex of a single triangle
-                    a = @lol_model.skin_file.indices[3 * i]
-                    b = @lol_model.skin_file.indices[3 * i + 1]
-                    c = @lol_model.skin_file.indices[3 * i + 2]
+                    #three vertex of a single triangle, 0 past the indices of a Native::SknMap
+                    a = @lol_model.skin_file.indices[3 * i].to_i
+                    b = @lol_model.skin_file.indices[3 * i + 1].to_i
+                    c = @lol_model.skin_file.indices[3 * i + 2].to_i
                     
                     tri = Md2File::Triangle.new
                     tri.index_xyz = [a, b, c]
@@ -130,8 +227,6 @@ module LolModelFormat
             end
             
             def get_md2_frame(frame_name, vertices)
-                puts frame_name
-                
                 frame = Md2File::Frame.new
                 
                 v_x_max = vertices.max_by { |v|  v.position.x.abs}.position.x
@@ -161,14 +256,36 @@ module LolModelFormat
                     
                     normal = v.normal
                     vertex.normal_index = 0
-                    vertex.normal_index = Md2File.get_anorms_index(
-                                            normal.x, normal.y, normal.z)
+                    vertex.normal_index = get_anorms_index(normal.x.to_f, normal.y.to_f, normal.z.to_f)
                     frame.verts << vertex       
                 end
                 
                 frame
             end
 
+            # frames "#{prefix}001", "#{prefix}002", ... of the animation,
+            # quantized by LolNative from the skinned buffers when it is built
+            def get_md2_frames(prefix, vertices, anm_file)
+                if LolModelFormat.native?
+                    @lol_model.get_animated_vertex_buffers(vertices, anm_file).each_with_index.map do |(positions, normals), i|
+                        read_md2_frame(get_md2_frame_from_buffers("%s%03d" % [prefix, i + 1], positions, normals))
+                    end
+                else
+                    @lol_model.get_animated_vertice_frames(vertices, anm_file).each_with_index.map do |frame_vertices, i|
+                        get_md2_frame("%s%03d" % [prefix, i + 1], frame_vertices)
+                    end
+                end
+            end
+
+            def get_anorms_index(normal_x, normal_y, normal_z)
+                return Md2File.get_anorms_index(normal_x, normal_y, normal_z) unless LolModelFormat.native?
+
+                index = Native.md2_anorm_index(normal_x, normal_y, normal_z)
+                raise "couldn't get anorms_index for [#{normal_x}, #{normal_y}, #{normal_z}] " if index.nil?
+
+                index
+            end
+
             def get_md2_skl_trianles(count)
                 triangles = []
                 
@@ -0,0 +1,16 @@
+# Zero-copy readers of .skn/.skl/.anm files (LolModelFormat::Native::SknMap,
+# SklMap and AnmMap), built by `rake build_lol_native`.
+#
+# The BinData records (SknFile, SklFile, AnmFile) remain the plain, debuggable
+# version; LolModel accepts either for its packed vertex and pose buffers.
+begin
+    require File.expand_path('../../../ext/lol_model_format/LolNative.so', __FILE__)
+rescue LoadError
+    puts "LolNative.so does not exist. Mapped readers are not available."
+end
+
+module LolModelFormat
+    def self.native?
+        defined?(LolModelFormat::Native::SknMap) ? true : false
+    end
+end
@@ -0,0 +1,147 @@
+require 'thread'
+
+module LolModelFormat
+
+    # Stages run by worker threads and connected by bounded queues. A worker
+    # waits when the queue of the next stage is full, so whatever the input
+    # size at most +capacity+ items wait between two stages.
+    #
+    # Ruby code of the workers runs one thread at a time; the native sections
+    # releasing the GVL (RSkeleton#evaluate, RVec3.skinVertices,
+    # Native.md2_frame) run in parallel.
+    class Pipeline
+
+        class Stage
+            attr_reader :name, :workers, :unit, :queue
+            attr_reader :items, :units, :busy, :stalled, :started_at, :finished_at
+
+            def initialize(name, workers, unit, capacity, &block)
+                @name = name
+                @workers = workers
+                @unit = unit
+                @queue = SizedQueue.new(capacity)
+                @block = block
+                @mutex = Mutex.new
+                @items = 0
+                @units = 0
+                @busy = 0.0
+                @stalled = 0.0
+            end
+
+            def process(item, emit)
+                @block.call(item, emit)
+            end
+
+            def count(units, started, finished, stalled)
+                @mutex.synchronize do
+                    @items += 1
+                    @units += units
+                    @busy += finished - started - stalled
+                    @stalled += stalled
+                    @started_at = started if @started_at.nil? || started < @started_at
+                    @finished_at = finished if @finished_at.nil? || finished > @finished_at
+                end
+            end
+
+            # seconds from the first item taken to the last one done
+            def wall
+                @started_at ? @finished_at - @started_at : 0.0
+            end
+
+            def to_h
+                {
+                    :stage => @name,
+                    :workers => @workers,
+                    :items => @items,
+                    :units => @units,
+                    :unit => @unit,
+                    :wall => wall,
+                    :busy => @busy,
+                    :stalled => @stalled,
+                    :units_per_second => wall > 0.0 ? @units / wall : 0.0
+                }
+            end
+        end
+
+        attr_reader :stages
+
+        def initialize(capacity)
+            @capacity = capacity
+            @stages = []
+            @mutex = Mutex.new
+            @error = nil
+        end
+
+        # Adds a stage run by +workers+ threads. The block gets each item and
+        # a lambda passing items on to the next stage, and returns the number
+        # of +unit+ (e.g. frames) it processed for the report.
+        def stage(name, workers, unit = 'items', &block)
+            @stages << Stage.new(name, workers, unit, @capacity, &block)
+            self
+        end
+
+        # feeds +inputs+ to the first stage and returns once the last one is
+        # done; the first error raised by a stage stops them all and is re-raised
+        def run(inputs)
+            closers = @stages.each_with_index.map do |stage, i|
+                following = @stages[i + 1]
+                workers = Array.new(stage.workers) { Thread.new { work(stage, following) } }
+
+                Thread.new do
+                    workers.each(&:join)
+                    following.queue.close if following
+                end
+            end
+
+            begin
+                inputs.each { |input| @stages.first.queue.push input }
+            rescue ClosedQueueError
+                # aborted by a stage
+            ensure
+                @stages.first.queue.close
+            end
+
+            closers.each(&:join)
+            raise @error if @error
+
+            self
+        end
+
+        def report
+            @stages.map(&:to_h)
+        end
+
+        private
+
+        def work(stage, following)
+            stalled = 0.0
+            emit = lambda do |item|
+                waiting = clock
+                following.queue.push item if following
+                stalled += clock - waiting
+            end
+
+            while (item = stage.queue.pop)
+                break if @error
+
+                stalled = 0.0
+                started = clock
+                units = stage.process(item, emit)
+                stage.count(units.to_i, started, clock, stalled)
+            end
+        rescue ClosedQueueError
+            # aborted by another stage
+        rescue Exception => e
+            abort e
+        end
+
+        def abort(error)
+            @mutex.synchronize { @error ||= error }
+            @stages.each { |stage| stage.queue.close }
+        end
+
+        def clock
+            Process.clock_gettime(Process::CLOCK_MONOTONIC)
+        end
+    end
+end
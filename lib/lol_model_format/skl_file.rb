@@ -30,35 +30,41 @@ module LolModelFormat
             
             #TODO validate
             def orientation
-                unless @orientation    
-                    orientation_transform = RMtx4.new.setIdentity
-                    
-                    orientation_transform.e00 = matrix[0].value
-                    orientation_transform.e10 = matrix[1].value
-                    orientation_transform.e20 = matrix[2].value
+                @orientation ||= SklBone.orientation_from_matrix(matrix.map { |e| e.value })
+                @orientation
+            end
+            
+            #TODO validate    
+            def position
+                @position ||= SklBone.position_from_matrix(matrix.map { |e| e.value })
+                @position
+            end
 
-                    orientation_transform.e01 = matrix[4].value
-                    orientation_transform.e11 = matrix[5].value
-                    orientation_transform.e21 = matrix[6].value
+            # also used for the matrices of Native::SklMap, +matrix+ holds 12 floats
+            def self.orientation_from_matrix(matrix)
+                orientation_transform = RMtx4.new.setIdentity
+                
+                orientation_transform.e00 = matrix[0]
+                orientation_transform.e10 = matrix[1]
+                orientation_transform.e20 = matrix[2]
 
-                    orientation_transform.e02 = matrix[8].value
-                    orientation_transform.e12 = matrix[9].value
-                    orientation_transform.e22 = matrix[10].value                    
+                orientation_transform.e01 = matrix[4]
+                orientation_transform.e11 = matrix[5]
+                orientation_transform.e21 = matrix[6]
 
-                    @orientation = RQuat.new.setIdentity.rotationMatrix( orientation_transform )
+                orientation_transform.e02 = matrix[8]
+                orientation_transform.e12 = matrix[9]
+                orientation_transform.e22 = matrix[10]
 
-                    @orientation = RQuat.new(@orientation.x, @orientation.y, -@orientation.z, -@orientation.w)
+                orientation = RQuat.new.setIdentity.rotationMatrix( orientation_transform )
 
-                    #TODO flip Z and W
-                end
-                @orientation
+                #TODO flip Z and W
+                RQuat.new(orientation.x, orientation.y, -orientation.z, -orientation.w)
             end
-            
-            #TODO validate    
-            def position
-                @position ||= RVec3.new(matrix[3].value, matrix[7].value, -matrix[11].value)
+
+            def self.position_from_matrix(matrix)
                 #TODO flip Z?
-                @position
+                RVec3.new(matrix[3], matrix[7], -matrix[11])
             end
 
             #TODO validate
@@ -0,0 +1,38 @@
+require 'spec_helper'
+require 'model_shared'
+include LolModelFormat::Md2
+
+describe LolModelFormat::BatchConverter do
+
+    include_context "model_shared"
+
+    before :all do
+        @output_dir = File.expand_path("../viewer/generated/batch", __FILE__)
+        @assets = BatchConverter.assets_in(File.expand_path("../fixture", __FILE__))
+    end
+
+    it 'should find the models of the fixture' do
+        @assets.map(&:name).should == ["Annie"]
+        @assets[0].animations.keys.should == ["Attack1"]
+    end
+
+    it 'should convert to the same md2 file as Md2Model' do
+        converter = BatchConverter.new(@output_dir, :workers => 4, :queue_size => 2)
+        files = converter.convert(@assets)
+
+        files.should == [File.join(@output_dir, "Annie.md2")]
+
+        md2 = StringIO.new
+        Md2Model.new(@models["Annie"]).to_md2.write(md2)
+        File.binread(files[0]).should == md2.string
+    end
+
+    it 'should report the throughput of each stage' do
+        converter = BatchConverter.new(@output_dir, :workers => 2)
+        converter.convert(@assets)
+
+        converter.stats.map { |s| s[:stage] }.should == %w[parse pose skin quantize write]
+        frames = 1 + @animations["Attack1"].number_of_frames
+        converter.stats[1..-1].each { |s| s[:units].should == frames }
+    end
+end
@@ -8,12 +8,17 @@ describe LolModelFormat::Dae::DaeModel do
 
     it 'should convert to dae file' do
         @models.each do |model_name, m|         
-            dae = DaeModel.new(m).to_dae
-            
             @dae_file_name = File.expand_path("../viewer/generated/#{model_name}.dae", __FILE__)
             wio = File.open(@dae_file_name, 'wb')           
-            wio.write(dae)
+            DaeModel.new(m).write_dae(wio)
             wio.close        
         end
     end
+
+    it 'should stream the same dae as the plain version' do
+        @models.each do |model_name, m|
+            dae = DaeModel.new(m)
+            dae.to_dae(model_name).should == dae.send(:render_dae, model_name)
+        end
+    end
 end
\ No newline at end of file
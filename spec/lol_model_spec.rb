@@ -10,5 +10,31 @@ describe LolModelFormat::LolModel do
             m.gen_bone_tree_from_skl   
         end
     end
+
+    it 'should resample animations at another fps' do
+        @models.each do |model_name, m|
+            m.animation_files.each do |animation_name, anm|
+                poses = m.get_anm_poses(anm)
+                frame_size = m.native_skeleton.size * RSkeleton::POSE_STRIDE * 4
+
+                m.get_anm_poses_at_fps(anm, anm.playback_fps).should == poses
+
+                resampled = m.get_anm_poses_at_fps(anm, 60)
+                resampled.bytesize.should == frame_size * ((anm.number_of_frames - 1) * 60 / anm.playback_fps + 1)
+                resampled[0, frame_size].should == poses[0, frame_size]
+            end
+        end
+    end
+
+    it 'should not pack bone indices out of a byte' do
+        model = LolModel.new(@skl, @skn, {})
+        def model.remap_bone_index(bone_index_orig)
+            256
+        end
+
+        lambda {
+            model.pack_vertices(@skn.vertices)
+        }.should raise_error(ArgumentError)
+    end
     
 end
\ No newline at end of file
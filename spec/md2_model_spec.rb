@@ -17,6 +17,31 @@ describe LolModelFormat::Md2::Md2Model do
         end
     end
 
+    it 'should write the same md2 file from packed frames' do
+        @models.each do |model_name, m|
+            md2_model = Md2Model.new(m)
+
+            packed = m.pack_vertices(m.skin_file.vertices)
+            frames = [md2_model.get_md2_frame_from_buffers('static001', packed.positions, packed.normals)]
+            m.animation_files.each do |name, anm_file|
+                m.get_animated_vertex_buffers(m.skin_file.vertices, anm_file).each_with_index do |(positions, normals), i|
+                    frames << md2_model.get_md2_frame_from_buffers(md2_model.md2_frame_name(name, i), positions, normals)
+                end
+            end
+
+            expected = StringIO.new
+            md2_model.to_md2.write(expected)
+
+            written = StringIO.new
+            md2_model.write_md2_from_frames(written, frames)
+            written.string.should == expected.string
+
+            from_frames = StringIO.new
+            md2_model.to_md2_from_frames(frames).write(from_frames)
+            from_frames.string.should == expected.string
+        end
+    end
+
     it 'should convert to md2 file for skeleton' do
         @models.each do |model_name, m|           
             md2 = Md2Model.new(m).to_md2_skl            
@@ -0,0 +1,153 @@
+require 'spec_helper'
+require 'model_shared'
+
+describe LolModelFormat::Native do
+    include_context "model_shared"
+
+    before :all do
+        @skl_map = Native::SklMap.new @skl_file_name
+        @skn_map = Native::SknMap.new @skn_file_name
+        @anm_map = Native::AnmMap.new File.expand_path('../fixture/Annie/Annie_Attack1.anm', __FILE__)
+        @anm = @animations["Attack1"]
+    end
+
+    after :all do
+        [@skl_map, @skn_map, @anm_map].each { |map| map.close }
+    end
+
+    it 'should map the same skn header as SknFile' do
+        @skn_map.version.should == @skn.version
+        @skn_map.num_of_objects.should == @skn.num_of_objects
+        @skn_map.num_of_indices.should == @skn.num_of_indices
+        @skn_map.num_of_vertices.should == @skn.num_of_vertices
+        @skn_map.material_headers[0][:num_of_indices].should == @skn.material_headers[0].num_of_indices
+        @skn_map.end_tab.should == @skn.end_tab.to_a
+    end
+
+    it 'should view the same skn indices and vertices as SknFile' do
+        @skn_map.indices.to_a.should == @skn.indices.to_a
+
+        [0, 100, @skn.vertices.size - 1].each do |i|
+            v = @skn.vertices[i]
+            @skn_map.positions[i].should == [v.position.x, v.position.y, v.position.z]
+            @skn_map.bone_indices[i].should == v.bone_index.to_a
+            @skn_map.weights[i].should == v.weights.to_a
+            @skn_map.normals[i].should == [v.normal.x, v.normal.y, v.normal.z]
+            @skn_map.tex_coords[i].should == [v.tex_coords.x, v.tex_coords.y]
+        end
+    end
+
+    it 'should view the same skl bones as SklFile' do
+        @skl_map.version.should == @skl.version
+        @skl_map.num_of_bones.should == @skl.num_of_bones
+        @skl_map.bone_names.should == @skl.bones.map { |bone| bone.name.to_s }
+        @skl_map.parent_ids.to_a.should == @skl.bones.map { |bone| bone.parent_id.to_i }
+        @skl_map.matrices[1].should == @skl.bones[1].matrix.to_a
+        @skl_map.bone_ids.to_a.should == @skl.bone_ids.to_a
+    end
+
+    it 'should view the same anm tracks as AnmFile' do
+        @anm_map.number_of_bones.should == @anm.number_of_bones
+        @anm_map.number_of_frames.should == @anm.number_of_frames
+        @anm_map.playback_fps.should == @anm.playback_fps
+
+        frame = @anm.bones[1].frames[5]
+        o, p = frame.orientation_origin, frame.position_origin
+        @anm_map.track(1)[5].should == [o.x, o.y, o.z, o.w, p.x, p.y, p.z]
+    end
+
+    it 'should pack the same buffers for LolModel as the BinData records' do
+        model = @models["Annie"]
+        mapped = LolModel.new @skl_map, @skn_map, "Attack1" => @anm_map
+
+        mapped.pack_vertices(@skn_map).to_a.should == model.pack_vertices(@skn.vertices).to_a
+        mapped.get_bind_pose.should == model.get_bind_pose
+        mapped.get_anm_poses(@anm_map).should == model.get_anm_poses(@anm)
+    end
+
+    it 'should convert a mapped model to the same md2 file' do
+        mapped = LolModel.new @skl_map, @skn_map, "Attack1" => @anm_map
+
+        expected = StringIO.new
+        Md2::Md2Model.new(@models["Annie"]).to_md2.write(expected)
+
+        written = StringIO.new
+        Md2::Md2Model.new(mapped).to_md2.write(written)
+        written.string.should == expected.string
+    end
+
+    it 'should reject unsupported files' do
+        lambda {
+            Native::AnmMap.new @skn_file_name
+        }.should raise_error(Native::FormatError)
+    end
+
+    it 'should not read through a closed map' do
+        map = Native::SknMap.new @skn_file_name
+        positions = map.positions
+        map.close
+
+        lambda { positions[0] }.should raise_error(IOError)
+    end
+
+    it 'should wrap its structs as typed data' do
+        require 'objspace'
+
+        map = Native::SknMap.new @skn_file_name
+        ObjectSpace.memsize_of(map).should > 0
+        ObjectSpace.memsize_of(map.positions).should > 0
+        map.close
+
+        writer = Native::DaeWriter.new(StringIO.new, 4096)
+        ObjectSpace.memsize_of(writer).should >= 4096
+    end
+
+    it 'should unlock the written strings when the io raises' do
+        io = Object.new
+        def io.write(data)
+            raise IOError, "closed"
+        end
+
+        writer = Native::DaeWriter.new(io, 64)
+        markup = "<p>" * 100
+        packed = ([1.5] * 100).pack('f*')
+
+        lambda { writer.write markup }.should raise_error(IOError)
+        lambda { writer.floats packed, 2 }.should raise_error(IOError)
+        lambda { markup << "</p>" }.should_not raise_error
+        lambda { packed << "\0" }.should_not raise_error
+    end
+
+    it 'should reject rounding floats to integers' do
+        writer = Native::DaeWriter.new(StringIO.new)
+        lambda { writer.floats [68.04].pack('f*'), 0 }.should raise_error(ArgumentError)
+    end
+
+    it 'should find the same anorms as Md2File.get_anorms_index' do
+        random = Random.new 20130526
+        normals = Md2::Md2File::Anorms.map { |n| n.map { |c| c * 0.999 } }
+        normals += Array.new(2000) { Array.new(3) { random.rand(-1.0..1.0) } }
+        normals += Array.new(200) { |i| n = Array.new(3) { random.rand(-1.0..1.0) }; n[i % 3] = 0.0; n }
+
+        model = @models["Annie"]
+        normals += model.get_animated_vertex_buffers(@skn.vertices, @anm).first[1].unpack('f*').each_slice(3).to_a
+
+        normals.each do |n|
+            Native.md2_anorm_index(*n).should == Md2::Md2File.get_anorms_index(*n)
+        end
+    end
+
+    it 'should quantize the same md2 frame as Md2Model' do
+        model = @models["Annie"]
+        positions, normals = model.get_animated_vertex_buffers(@skn.vertices, @anm)[5]
+
+        vector = Struct.new(:x, :y, :z)
+        vertex = Struct.new(:position, :normal)
+        vertices = positions.unpack('f*').each_slice(3).zip(normals.unpack('f*').each_slice(3)).map do |p, n|
+            vertex.new(vector.new(*p), vector.new(*n))
+        end
+
+        frame = Md2::Md2Model.new(model).send(:get_md2_frame, "Attack1006", vertices)
+        Native.md2_frame("Attack1006", positions, normals).should == frame.to_binary_s
+    end
+end
@@ -0,0 +1,47 @@
+require 'spec_helper'
+
+describe LolModelFormat::Pipeline do
+
+    it 'should pass each item through all the stages' do
+        results = Queue.new
+
+        pipeline = Pipeline.new(2)
+        pipeline.stage('double', 3) { |i, emit| emit.call(2 * i); 1 }
+        pipeline.stage('split', 2) { |i, emit| emit.call(i); emit.call(i + 1); 2 }
+        pipeline.stage('collect', 1) { |i, emit| results << i; 1 }
+        pipeline.run(1..10)
+
+        Array.new(results.size) { results.pop }.sort.should == (1..10).flat_map { |i| [2 * i, 2 * i + 1] }.sort
+        pipeline.report.map { |s| s[:units] }.should == [10, 20, 20]
+    end
+
+    it 'should bound the items waiting between two stages' do
+        produced = 0
+        consumed = 0
+        ahead = 0
+        mutex = Mutex.new
+
+        pipeline = Pipeline.new(2)
+        pipeline.stage('produce', 1) do |i, emit|
+            mutex.synchronize { produced += 1; ahead = [ahead, produced - consumed].max }
+            emit.call i
+        end
+        pipeline.stage('consume', 1) do |i, emit|
+            sleep 0.001
+            mutex.synchronize { consumed += 1 }
+        end
+        pipeline.run(1..50)
+
+        consumed.should == 50
+        # the queue, the item being consumed and the one being pushed
+        ahead.should <= 4
+    end
+
+    it 'should stop and re-raise the first error' do
+        pipeline = Pipeline.new(1)
+        pipeline.stage('fail', 2) { |i, emit| raise ArgumentError, "item #{i}" if i == 3; emit.call i }
+        pipeline.stage('pass', 1) { |i, emit| 1 }
+
+        lambda { pipeline.run(1..1000) }.should raise_error(ArgumentError)
+    end
+end